@@ -4,6 +4,7 @@
 #include <pthread.h>
 #include <stdbool.h>
 #include <time.h>
+#include "wire_protocol.h"
 
 #define TOTAL_FRAMES 240
 #define OBSTACLE_FRAME_START 59
@@ -22,26 +23,105 @@ typedef struct {
     bool is_valid;
 } SensorData;
 
-// Video packet structure (matches server)
+// Latest frame metadata (from the stream's META messages)
 typedef struct {
     int frame_id;
-    char frame_path[256];
     int frame_width;
     int frame_height;
     SensorData sensor;
 } VideoPacket;
 
+// Latest obstacle alert (ALERT messages)
+typedef struct {
+    int frame_id;               // 0 = none yet
+    char type[WIRE_ALERT_TYPE_BYTES];
+    double confidence;
+    SensorData sensor;
+} AlertInfo;
+
+// Where one frame's time went, CLOCK_REALTIME ns (0 = not seen). The first
+// four come from the server (see WIRE_META_SIZE), the rest are ours.
+typedef struct {
+    uint32_t frame_id;
+    uint64_t capture_ns;
+    uint64_t encode_ns;
+    uint64_t send_ns;               // META sent
+    uint64_t first_chunk_sent_ns;
+    uint64_t first_chunk_ns;        // First chunk received
+    uint64_t complete_ns;           // Reassembled
+    uint64_t decoded_ns;
+    uint64_t displayed_ns;
+} FrameTiming;
+
+// Latency stages, each from one FrameTiming stamp to the next
+enum {
+    LATENCY_ENCODE,                 // capture -> encode
+    LATENCY_QUEUE,                  // encode -> send (cache, pacing)
+    LATENCY_SEND,                   // send -> first chunk queued
+    LATENCY_NETWORK,                // first chunk queued -> received
+    LATENCY_TRANSFER,               // first chunk -> frame complete
+    LATENCY_DECODE,                 // complete -> decoded (includes the player's wait)
+    LATENCY_DISPLAY,                // decoded -> shown
+    LATENCY_TOTAL,                  // capture -> shown
+    LATENCY_STAGES
+};
+
+// Log2 buckets: bucket 0 holds < LATENCY_BUCKET_MIN_MS, bucket i < MIN * 2^i,
+// the last one everything slower
+#define LATENCY_BUCKETS 16
+#define LATENCY_BUCKET_MIN_MS 0.125
+
+typedef struct {
+    long counts[LATENCY_BUCKETS];
+    long samples;
+    long negative;                  // End stamped before start: clocks out of sync
+    double sum_ms;
+    double max_ms;
+} LatencyHistogram;
+
+// Latest reassembled frame (a JPEG or a TILES frame), handed from the
+// stream receiver to the player. The player may skip frames, so the last
+// TILES keyframe is kept as well: any later delta can be drawn over it.
+typedef struct {
+    unsigned char data[WIRE_MAX_FRAME_BYTES];
+    uint32_t length;
+    int frame_id;
+    FrameTiming timing;
+    unsigned char key[WIRE_MAX_FRAME_BYTES];
+    uint32_t key_length;
+    uint32_t key_frame_id;      // 0 = no keyframe yet
+    long published;             // Frames handed over so far
+    pthread_mutex_t mutex;
+    pthread_cond_t ready;
+} LatestFrame;
+
 // Client state for managing received data
 typedef struct {
     VideoPacket latest_packet;
+    AlertInfo latest_alert;
     int total_received;
+    int total_alerts;
     bool new_data;
     bool system_active;
     pthread_mutex_t data_mutex;
+    LatestFrame frame;
+    long frames_out_of_order;   // Completed after a newer frame, not shown
+    // Receiver records the stages up to LATENCY_TRANSFER, the player the
+    // rest; each histogram has a single writer, read after both stopped
+    LatencyHistogram latency[LATENCY_STAGES];
 } ClientState;
 
+extern ClientState client_state;
+
+// Latency telemetry (client_main.c)
+void latency_record(int stage, uint64_t start_ns, uint64_t end_ns);
+void latency_report(const char* csv_path);
+
 // Configuration
-#define UDP_PORT 8888
+#define UDP_PORT 8888               // The server's one stream: meta, alerts, frame chunks
+#define SERVER_IP "127.0.0.1"       // Default server to SUBSCRIBE to (first argument overrides)
+#define UDP_SERVER_PORT 8887        // Server port: SUBSCRIBE and NACK messages go here
+#define LATENCY_CSV_PATH "latency_histogram.csv"
 
 #endif
 
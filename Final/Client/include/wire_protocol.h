@@ -0,0 +1,650 @@
+#ifndef WIRE_PROTOCOL_H
+#define WIRE_PROTOCOL_H
+
+// On-the-wire formats shared by the servers and the client. This header is
+// kept identical in every tree. Fields are fixed width and big-endian and
+// are only ever read or written through the encode/decode helpers below;
+// a datagram is never cast to a struct.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <netinet/in.h>
+
+#define WIRE_IP_UDP_OVERHEAD 28         // IPv4 + UDP headers
+#define WIRE_MAX_DATAGRAM 65507         // Largest UDP payload over IPv4
+#define WIRE_MAX_FRAME_BYTES (200 * 1024)
+#define WIRE_MAX_CHUNKS 1024
+#define WIRE_MIN_CHUNK_PAYLOAD 256
+
+static inline void wire_put_u16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static inline void wire_put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static inline void wire_put_u64(uint8_t* p, uint64_t v) {
+    wire_put_u32(p, (uint32_t)(v >> 32));
+    wire_put_u32(p + 4, (uint32_t)v);
+}
+
+static inline void wire_put_f64(uint8_t* p, double v) {
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    wire_put_u64(p, bits);
+}
+
+static inline uint16_t wire_get_u16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t wire_get_u32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline uint64_t wire_get_u64(const uint8_t* p) {
+    return ((uint64_t)wire_get_u32(p) << 32) | wire_get_u32(p + 4);
+}
+
+static inline double wire_get_f64(const uint8_t* p) {
+    uint64_t bits = wire_get_u64(p);
+    double v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+// Local elapsed time (timeouts, deadlines)
+static inline uint64_t wire_now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+// Wall-clock time carried in message headers
+static inline uint64_t wire_realtime_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+// ---------------------------------------------------------------------------
+// Stream messages. One server socket sends every kind of message to every
+// subscriber; each datagram starts with the same typed header:
+//
+//   magic(2) version(1) kind(1) frame_id(4) sequence(4) timestamp_ns(8)
+//   source_id(1)
+//
+// A server with several camera feeds runs one stream per feed from the
+// same socket; source_id names the feed, and frame_id and sequence count
+// within it. Client messages carry the feed they are about, so a NACK,
+// SUBSCRIBE or REPORT reaches that feed's stream.
+// sequence counts every message of the stream, whatever its kind, so the
+// receiver sees metadata, alerts and pixels in the order they were sent.
+// Chunks resent for one receiver's NACK carry sequence 0: they are outside
+// the stream, and the gaps they would leave elsewhere are not losses.
+// timestamp_ns is the sender's CLOCK_REALTIME when the message was built.
+// ---------------------------------------------------------------------------
+
+#define WIRE_MAGIC 0x4156               // "AV"
+#define WIRE_VERSION 8
+#define WIRE_HEADER_SIZE 21
+
+#define WIRE_MSG_META 1                 // Sensor record of a frame, sent before its pixels
+#define WIRE_MSG_CHUNK 2                // Slice of a frame's JPEG (or parity)
+#define WIRE_MSG_ALERT 3                // Obstacle detection
+#define WIRE_MSG_NACK 4                 // Client -> server: chunks still missing
+#define WIRE_MSG_SUBSCRIBE 5            // Client -> server: join / renew / leave
+#define WIRE_MSG_REPORT 6               // Client -> server: what got through lately
+#define WIRE_MSG_COOKIE 7               // Server -> client: echo this in SUBSCRIBE
+
+typedef struct {
+    uint8_t kind;
+    uint32_t frame_id;
+    uint32_t sequence;
+    uint64_t timestamp_ns;
+    uint8_t source_id;          // Feed, 0 = primary
+} WireHeader;
+
+static inline void wire_header_encode(const WireHeader* h, uint8_t kind, uint8_t* out) {
+    wire_put_u16(out, WIRE_MAGIC);
+    out[2] = WIRE_VERSION;
+    out[3] = kind;
+    wire_put_u32(out + 4, h->frame_id);
+    wire_put_u32(out + 8, h->sequence);
+    wire_put_u64(out + 12, h->timestamp_ns);
+    out[20] = h->source_id;
+}
+
+// Any message: checks magic and version and reads the header
+static inline bool wire_header_decode(const uint8_t* in, size_t length, WireHeader* h) {
+    if (length < WIRE_HEADER_SIZE || wire_get_u16(in) != WIRE_MAGIC || in[2] != WIRE_VERSION) {
+        return false;
+    }
+    h->kind = in[3];
+    h->frame_id = wire_get_u32(in + 4);
+    h->sequence = wire_get_u32(in + 8);
+    h->timestamp_ns = wire_get_u64(in + 12);
+    h->source_id = in[20];
+    return true;
+}
+
+// Telemetry record shared by META and ALERT. Fixed point, so a reading
+// decodes the same on every host and costs 27 bytes rather than four
+// doubles and a time_t:
+//   flags(1) sequence(4) time_ns(8) latitude(4) longitude(4) altitude(4) speed(2)
+// latitude and longitude are signed 1e-7 degrees (about 1 cm), altitude
+// signed centimetres and speed unsigned 0.1 km/h; values out of range are
+// clamped. sequence numbers the sensor's readings and time_ns is when the
+// reading was taken, CLOCK_REALTIME.
+#define WIRE_TELEMETRY_SIZE 27
+#define WIRE_TELEMETRY_VALID 0x01       // flags: the reading is usable
+
+#define WIRE_DEGREE_UNITS 1e7
+#define WIRE_ALTITUDE_UNITS 100.0       // Per metre
+#define WIRE_SPEED_UNITS 10.0           // Per km/h
+
+typedef struct {
+    uint8_t flags;
+    uint32_t sequence;
+    uint64_t time_ns;
+    double latitude;            // Degrees
+    double longitude;
+    double altitude;            // Metres
+    double speed;               // km/h
+} WireTelemetry;
+
+// value * units rounded to the nearest integer in [min, max]
+static inline int64_t wire_fixed(double value, double units, int64_t min, int64_t max) {
+    double scaled = value * units;
+    if (scaled != scaled) return 0;                 // NaN
+    if (scaled <= (double)min) return min;
+    if (scaled >= (double)max) return max;
+    return (int64_t)(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+}
+
+static inline void wire_telemetry_encode(const WireTelemetry* t, uint8_t* out) {
+    out[0] = t->flags;
+    wire_put_u32(out + 1, t->sequence);
+    wire_put_u64(out + 5, t->time_ns);
+    wire_put_u32(out + 13, (uint32_t)wire_fixed(t->latitude, WIRE_DEGREE_UNITS, INT32_MIN, INT32_MAX));
+    wire_put_u32(out + 17, (uint32_t)wire_fixed(t->longitude, WIRE_DEGREE_UNITS, INT32_MIN, INT32_MAX));
+    wire_put_u32(out + 21, (uint32_t)wire_fixed(t->altitude, WIRE_ALTITUDE_UNITS, INT32_MIN, INT32_MAX));
+    wire_put_u16(out + 25, (uint16_t)wire_fixed(t->speed, WIRE_SPEED_UNITS, 0, UINT16_MAX));
+}
+
+static inline void wire_telemetry_decode(const uint8_t* in, WireTelemetry* t) {
+    t->flags = in[0];
+    t->sequence = wire_get_u32(in + 1);
+    t->time_ns = wire_get_u64(in + 5);
+    t->latitude = (int32_t)wire_get_u32(in + 13) / WIRE_DEGREE_UNITS;
+    t->longitude = (int32_t)wire_get_u32(in + 17) / WIRE_DEGREE_UNITS;
+    t->altitude = (int32_t)wire_get_u32(in + 21) / WIRE_ALTITUDE_UNITS;
+    t->speed = wire_get_u16(in + 25) / WIRE_SPEED_UNITS;
+}
+
+// META: header, width(2) height(2), telemetry record, capture_ns(8) encode_ns(8).
+// Latency telemetry: capture_ns and encode_ns are the server's CLOCK_REALTIME
+// when the frame was captured and encoded (0 = unknown), the META header's
+// timestamp is when the frame's sending began, and its chunks' timestamp is
+// when the first of them was queued. Receivers stamp arrival, decode and
+// display on their own clock, so cross-host stages need synchronized clocks.
+#define WIRE_META_SIZE (WIRE_HEADER_SIZE + 4 + WIRE_TELEMETRY_SIZE + 16)
+
+typedef struct {
+    WireHeader header;
+    uint16_t width;
+    uint16_t height;
+    WireTelemetry telemetry;
+    uint64_t capture_ns;
+    uint64_t encode_ns;
+} WireMeta;
+
+static inline size_t wire_meta_encode(const WireMeta* m, uint8_t out[WIRE_META_SIZE]) {
+    wire_header_encode(&m->header, WIRE_MSG_META, out);
+    wire_put_u16(out + WIRE_HEADER_SIZE, m->width);
+    wire_put_u16(out + WIRE_HEADER_SIZE + 2, m->height);
+    wire_telemetry_encode(&m->telemetry, out + WIRE_HEADER_SIZE + 4);
+    wire_put_u64(out + WIRE_HEADER_SIZE + 4 + WIRE_TELEMETRY_SIZE, m->capture_ns);
+    wire_put_u64(out + WIRE_HEADER_SIZE + 12 + WIRE_TELEMETRY_SIZE, m->encode_ns);
+    return WIRE_META_SIZE;
+}
+
+static inline bool wire_meta_decode(const uint8_t* in, size_t length, WireMeta* m) {
+    if (length != WIRE_META_SIZE || !wire_header_decode(in, length, &m->header) ||
+        m->header.kind != WIRE_MSG_META) {
+        return false;
+    }
+    m->width = wire_get_u16(in + WIRE_HEADER_SIZE);
+    m->height = wire_get_u16(in + WIRE_HEADER_SIZE + 2);
+    wire_telemetry_decode(in + WIRE_HEADER_SIZE + 4, &m->telemetry);
+    m->capture_ns = wire_get_u64(in + WIRE_HEADER_SIZE + 4 + WIRE_TELEMETRY_SIZE);
+    m->encode_ns = wire_get_u64(in + WIRE_HEADER_SIZE + 12 + WIRE_TELEMETRY_SIZE);
+    return true;
+}
+
+// ALERT: header, telemetry record, confidence(8), detection type (NUL padded)
+#define WIRE_ALERT_TYPE_BYTES 64
+#define WIRE_ALERT_SIZE (WIRE_HEADER_SIZE + WIRE_TELEMETRY_SIZE + 8 + WIRE_ALERT_TYPE_BYTES)
+
+typedef struct {
+    WireHeader header;
+    WireTelemetry telemetry;
+    double confidence;
+    char type[WIRE_ALERT_TYPE_BYTES];   // Always NUL terminated once decoded
+} WireAlert;
+
+static inline size_t wire_alert_encode(const WireAlert* a, uint8_t out[WIRE_ALERT_SIZE]) {
+    uint8_t* body = out + WIRE_HEADER_SIZE;
+    wire_header_encode(&a->header, WIRE_MSG_ALERT, out);
+    wire_telemetry_encode(&a->telemetry, body);
+    wire_put_f64(body + WIRE_TELEMETRY_SIZE, a->confidence);
+    memset(body + WIRE_TELEMETRY_SIZE + 8, 0, WIRE_ALERT_TYPE_BYTES);
+    size_t type_length = strnlen(a->type, WIRE_ALERT_TYPE_BYTES - 1);
+    memcpy(body + WIRE_TELEMETRY_SIZE + 8, a->type, type_length);
+    return WIRE_ALERT_SIZE;
+}
+
+static inline bool wire_alert_decode(const uint8_t* in, size_t length, WireAlert* a) {
+    if (length != WIRE_ALERT_SIZE || !wire_header_decode(in, length, &a->header) ||
+        a->header.kind != WIRE_MSG_ALERT) {
+        return false;
+    }
+    const uint8_t* body = in + WIRE_HEADER_SIZE;
+    wire_telemetry_decode(body, &a->telemetry);
+    a->confidence = wire_get_f64(body + WIRE_TELEMETRY_SIZE);
+    memcpy(a->type, body + WIRE_TELEMETRY_SIZE + 8, WIRE_ALERT_TYPE_BYTES);
+    a->type[WIRE_ALERT_TYPE_BYTES - 1] = '\0';
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// CHUNK: header, chunk fields, then payload_length JPEG bytes. Every chunk
+// but the last carries chunk_size bytes, so chunk i starts at
+// i * chunk_size in the frame and no padding is ever sent.
+//
+// With fec_group = k > 0, data chunks are taken in groups of k and each
+// group is followed by one parity chunk (WIRE_CHUNK_PARITY, chunk_id = group
+// index) holding the XOR of the group's payloads, each zero-extended to the
+// group's first chunk. Any single lost chunk of a group can be rebuilt from
+// the rest, at 1/k extra bandwidth.
+// ---------------------------------------------------------------------------
+
+#define WIRE_CHUNK_HEADER_SIZE (WIRE_HEADER_SIZE + 15)
+#define WIRE_CHUNK_PARITY 0x01          // flags: XOR parity of one chunk group
+
+typedef struct {
+    WireHeader header;          // frame_id: the frame this chunk belongs to
+    uint32_t frame_length;      // Whole JPEG size in bytes
+    uint16_t chunk_id;
+    uint16_t total_chunks;
+    uint16_t chunk_size;        // Payload bytes of every chunk but the last
+    uint16_t payload_length;    // Payload bytes in this datagram
+    uint16_t fec_group;         // Data chunks per parity chunk, 0 = no FEC
+    uint8_t flags;
+} WireChunkHeader;
+
+static inline uint16_t wire_chunk_count(uint32_t frame_length, uint16_t chunk_size) {
+    return (uint16_t)((frame_length + chunk_size - 1) / chunk_size);
+}
+
+// Payload bytes of data chunk chunk_id
+static inline uint32_t wire_chunk_length(uint32_t frame_length, uint16_t chunk_size,
+                                         uint32_t chunk_id) {
+    uint32_t offset = chunk_id * chunk_size;
+    return frame_length - offset < chunk_size ? frame_length - offset : chunk_size;
+}
+
+static inline uint16_t wire_fec_groups(uint16_t total_chunks, uint16_t fec_group) {
+    return fec_group ? (uint16_t)((total_chunks + fec_group - 1) / fec_group) : 0;
+}
+
+static inline void wire_xor(uint8_t* dst, const uint8_t* src, size_t length) {
+    for (size_t i = 0; i < length; i++) dst[i] ^= src[i];
+}
+
+// Chunk fields: flags(1) fec_group(2) frame_length(4) chunk_id(2)
+//               total_chunks(2) chunk_size(2) payload_length(2)
+static inline void wire_chunk_header_encode(const WireChunkHeader* c,
+                                            uint8_t out[WIRE_CHUNK_HEADER_SIZE]) {
+    uint8_t* body = out + WIRE_HEADER_SIZE;
+    wire_header_encode(&c->header, WIRE_MSG_CHUNK, out);
+    body[0] = c->flags;
+    wire_put_u16(body + 1, c->fec_group);
+    wire_put_u32(body + 3, c->frame_length);
+    wire_put_u16(body + 7, c->chunk_id);
+    wire_put_u16(body + 9, c->total_chunks);
+    wire_put_u16(body + 11, c->chunk_size);
+    wire_put_u16(body + 13, c->payload_length);
+}
+
+// Rejects anything that is not a well-formed chunk of a sane frame
+static inline bool wire_chunk_header_decode(const uint8_t* in, size_t length,
+                                            WireChunkHeader* c) {
+    if (length < WIRE_CHUNK_HEADER_SIZE || !wire_header_decode(in, length, &c->header) ||
+        c->header.kind != WIRE_MSG_CHUNK) {
+        return false;
+    }
+    const uint8_t* body = in + WIRE_HEADER_SIZE;
+    c->flags = body[0];
+    c->fec_group = wire_get_u16(body + 1);
+    c->frame_length = wire_get_u32(body + 3);
+    c->chunk_id = wire_get_u16(body + 7);
+    c->total_chunks = wire_get_u16(body + 9);
+    c->chunk_size = wire_get_u16(body + 11);
+    c->payload_length = wire_get_u16(body + 13);
+
+    if (c->payload_length != length - WIRE_CHUNK_HEADER_SIZE || c->chunk_size == 0 ||
+        c->frame_length == 0 || c->frame_length > WIRE_MAX_FRAME_BYTES ||
+        c->total_chunks > WIRE_MAX_CHUNKS ||
+        c->total_chunks != wire_chunk_count(c->frame_length, c->chunk_size)) {
+        return false;
+    }
+    if (c->flags & WIRE_CHUNK_PARITY) {
+        return c->chunk_id < wire_fec_groups(c->total_chunks, c->fec_group) &&
+               c->payload_length == wire_chunk_length(c->frame_length, c->chunk_size,
+                                                      (uint32_t)c->chunk_id * c->fec_group);
+    }
+    return c->chunk_id < c->total_chunks &&
+           c->payload_length == wire_chunk_length(c->frame_length, c->chunk_size, c->chunk_id);
+}
+
+// Largest chunk payload that fits one datagram on a link with this MTU
+static inline uint16_t wire_chunk_payload_for_mtu(int mtu) {
+    int payload = mtu - WIRE_IP_UDP_OVERHEAD - WIRE_CHUNK_HEADER_SIZE;
+    if (payload > WIRE_MAX_DATAGRAM - WIRE_CHUNK_HEADER_SIZE) {
+        payload = WIRE_MAX_DATAGRAM - WIRE_CHUNK_HEADER_SIZE;
+    }
+    if (payload < WIRE_MIN_CHUNK_PAYLOAD) payload = WIRE_MIN_CHUNK_PAYLOAD;
+    return (uint16_t)payload;
+}
+
+// ---------------------------------------------------------------------------
+// TILES: what a frame's chunks carry from a tile delta server, instead of a
+// bare JPEG (receivers tell them apart by the magic; a JPEG starts FF D8):
+//
+//   magic(2) flags(1) tile_size(1) columns(1) rows(1) reference(4)
+//
+// A WIRE_TILES_KEY frame follows with the JPEG of the whole frame, and
+// reference is its own frame id. Any other frame follows with a bitmap of
+// columns * rows bits (tile row * columns + column), then a JPEG atlas of
+// the marked tiles in bitmap order, min(count, columns) tiles to a row;
+// there is no atlas when no tile is marked. The tiles are drawn over the
+// keyframe reference, never over another delta, so a delta that is lost
+// or skipped costs nothing but itself. Edge tiles are cut to the frame
+// size; their atlas cells are not.
+// ---------------------------------------------------------------------------
+
+#define WIRE_TILES_MAGIC 0x544C         // "TL"
+#define WIRE_TILES_HEADER_SIZE 10
+#define WIRE_TILES_KEY 0x01             // flags: whole frame, the next deltas' reference
+
+typedef struct {
+    uint8_t flags;
+    uint8_t tile_size;          // Pixels
+    uint8_t columns;
+    uint8_t rows;
+    uint32_t reference;         // Keyframe the tiles go over
+} WireTiles;
+
+static inline size_t wire_tiles_bitmap_size(const WireTiles* tiles) {
+    return (tiles->flags & WIRE_TILES_KEY) ? 0 : ((size_t)tiles->columns * tiles->rows + 7) / 8;
+}
+
+static inline bool wire_tiles_marked(const uint8_t* bitmap, int tile) {
+    return bitmap[tile / 8] & (1u << (tile % 8));
+}
+
+static inline size_t wire_tiles_encode(const WireTiles* tiles, uint8_t out[WIRE_TILES_HEADER_SIZE]) {
+    wire_put_u16(out, WIRE_TILES_MAGIC);
+    out[2] = tiles->flags;
+    out[3] = tiles->tile_size;
+    out[4] = tiles->columns;
+    out[5] = tiles->rows;
+    wire_put_u32(out + 6, tiles->reference);
+    return WIRE_TILES_HEADER_SIZE;
+}
+
+// False for anything that is not a tile frame (a plain JPEG, say)
+static inline bool wire_tiles_decode(const uint8_t* in, size_t length, WireTiles* tiles) {
+    if (length < WIRE_TILES_HEADER_SIZE || wire_get_u16(in) != WIRE_TILES_MAGIC) return false;
+    tiles->flags = in[2];
+    tiles->tile_size = in[3];
+    tiles->columns = in[4];
+    tiles->rows = in[5];
+    tiles->reference = wire_get_u32(in + 6);
+    return tiles->tile_size > 0 && tiles->columns > 0 && tiles->rows > 0 &&
+           length >= WIRE_TILES_HEADER_SIZE + wire_tiles_bitmap_size(tiles);
+}
+
+// ---------------------------------------------------------------------------
+// NACK (client -> the address the stream came from): which data chunks of
+// frame header.frame_id are still missing, as a bitmap where bit i stands
+// for chunk first_chunk + i. The sender resends them until the frame is
+// WIRE_REPAIR_DEADLINE_MS old; after that a frame is not worth repairing.
+// ---------------------------------------------------------------------------
+
+#define WIRE_NACK_HEADER_SIZE (WIRE_HEADER_SIZE + 4)
+#define WIRE_NACK_MAX_SIZE (WIRE_NACK_HEADER_SIZE + WIRE_MAX_CHUNKS / 8)
+#define WIRE_NACK_DELAY_MS 10           // Quiet time after a frame's last chunk before NACKing
+#define WIRE_NACK_RETRY_MS 40           // Between NACKs for the same frame
+#define WIRE_REPAIR_DEADLINE_MS 300     // Frame age after which repair stops
+
+typedef struct {
+    WireHeader header;
+    uint16_t first_chunk;
+    uint16_t chunk_count;       // Bits used in missing[]
+    uint8_t missing[WIRE_MAX_CHUNKS / 8];
+} WireNack;
+
+static inline bool wire_nack_missing(const WireNack* nack, int i) {
+    return nack->missing[i / 8] & (1u << (i % 8));
+}
+
+// Body: first_chunk(2) chunk_count(2) missing(ceil(chunk_count / 8)).
+// Returns the encoded size.
+static inline size_t wire_nack_encode(const WireNack* nack, uint8_t out[WIRE_NACK_MAX_SIZE]) {
+    size_t bitmap_bytes = (nack->chunk_count + 7) / 8;
+    wire_header_encode(&nack->header, WIRE_MSG_NACK, out);
+    wire_put_u16(out + WIRE_HEADER_SIZE, nack->first_chunk);
+    wire_put_u16(out + WIRE_HEADER_SIZE + 2, nack->chunk_count);
+    memcpy(out + WIRE_NACK_HEADER_SIZE, nack->missing, bitmap_bytes);
+    return WIRE_NACK_HEADER_SIZE + bitmap_bytes;
+}
+
+static inline bool wire_nack_decode(const uint8_t* in, size_t length, WireNack* nack) {
+    if (length < WIRE_NACK_HEADER_SIZE || !wire_header_decode(in, length, &nack->header) ||
+        nack->header.kind != WIRE_MSG_NACK) {
+        return false;
+    }
+    nack->first_chunk = wire_get_u16(in + WIRE_HEADER_SIZE);
+    nack->chunk_count = wire_get_u16(in + WIRE_HEADER_SIZE + 2);
+    size_t bitmap_bytes = (nack->chunk_count + 7) / 8;
+    if (nack->chunk_count == 0 || nack->chunk_count > WIRE_MAX_CHUNKS ||
+        length != WIRE_NACK_HEADER_SIZE + bitmap_bytes) {
+        return false;
+    }
+    memcpy(nack->missing, in + WIRE_NACK_HEADER_SIZE, bitmap_bytes);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// SUBSCRIBE (client -> server): header, flags(1) cookie(8). The server
+// streams to the address the message came from for WIRE_SUBSCRIBE_LEASE_MS;
+// clients renew every WIRE_SUBSCRIBE_INTERVAL_MS, so a few lost heartbeats
+// do not drop them, and send WIRE_SUBSCRIBE_LEAVE on the way out.
+//
+// A SUBSCRIBE only counts with a cookie the server handed to that address.
+// Anything else (cookie 0 on the first try, or a stale one) is answered
+// with a COOKIE to the source address and nothing else; the client sends
+// its SUBSCRIBE again with the cookie echoed. So a forged source address
+// can neither turn the stream on a third party nor drop a subscriber, and
+// the COOKIE is no bigger than the SUBSCRIBE that drew it.
+//
+// COOKIE (server -> client): header (sequence 0, outside the stream),
+// cookie(8). Cookies change from time to time; the client keeps using the
+// last one it got.
+// ---------------------------------------------------------------------------
+
+#define WIRE_SUBSCRIBE_SIZE (WIRE_HEADER_SIZE + 9)
+#define WIRE_SUBSCRIBE_LEAVE 0x01       // flags: stop streaming to me
+#define WIRE_SUBSCRIBE_INTERVAL_MS 1000
+#define WIRE_SUBSCRIBE_LEASE_MS 3500
+#define WIRE_COOKIE_SIZE (WIRE_HEADER_SIZE + 8)
+
+typedef struct {
+    WireHeader header;
+    uint8_t flags;
+    uint64_t cookie;            // Last COOKIE from the server, 0 = none yet
+} WireSubscribe;
+
+static inline size_t wire_subscribe_encode(const WireSubscribe* subscribe,
+                                           uint8_t out[WIRE_SUBSCRIBE_SIZE]) {
+    wire_header_encode(&subscribe->header, WIRE_MSG_SUBSCRIBE, out);
+    out[WIRE_HEADER_SIZE] = subscribe->flags;
+    wire_put_u64(out + WIRE_HEADER_SIZE + 1, subscribe->cookie);
+    return WIRE_SUBSCRIBE_SIZE;
+}
+
+static inline bool wire_subscribe_decode(const uint8_t* in, size_t length,
+                                         WireSubscribe* subscribe) {
+    if (length != WIRE_SUBSCRIBE_SIZE || !wire_header_decode(in, length, &subscribe->header) ||
+        subscribe->header.kind != WIRE_MSG_SUBSCRIBE) {
+        return false;
+    }
+    subscribe->flags = in[WIRE_HEADER_SIZE];
+    subscribe->cookie = wire_get_u64(in + WIRE_HEADER_SIZE + 1);
+    return true;
+}
+
+typedef struct {
+    WireHeader header;
+    uint64_t cookie;
+} WireCookie;
+
+static inline size_t wire_cookie_encode(const WireCookie* cookie, uint8_t out[WIRE_COOKIE_SIZE]) {
+    wire_header_encode(&cookie->header, WIRE_MSG_COOKIE, out);
+    wire_put_u64(out + WIRE_HEADER_SIZE, cookie->cookie);
+    return WIRE_COOKIE_SIZE;
+}
+
+static inline bool wire_cookie_decode(const uint8_t* in, size_t length, WireCookie* cookie) {
+    if (length != WIRE_COOKIE_SIZE || !wire_header_decode(in, length, &cookie->header) ||
+        cookie->header.kind != WIRE_MSG_COOKIE) {
+        return false;
+    }
+    cookie->cookie = wire_get_u64(in + WIRE_HEADER_SIZE);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// REPORT (client -> server): header, interval_ms(4) messages(4) lost(4)
+// bytes(4). Every WIRE_REPORT_INTERVAL_MS a receiver tells the sender how
+// many stream messages and bytes reached it over the last interval_ms, and
+// how many it saw go missing (gaps in the sequence), so the sender can fit
+// its frames to what the worst receiver gets through.
+// ---------------------------------------------------------------------------
+
+#define WIRE_REPORT_SIZE (WIRE_HEADER_SIZE + 16)
+#define WIRE_REPORT_INTERVAL_MS 500
+
+typedef struct {
+    WireHeader header;
+    uint32_t interval_ms;       // Time covered by this report
+    uint32_t messages;          // Received in that time
+    uint32_t lost;              // Sequence numbers skipped in that time
+    uint32_t bytes;             // Datagram bytes received in that time
+} WireReport;
+
+static inline size_t wire_report_encode(const WireReport* report, uint8_t out[WIRE_REPORT_SIZE]) {
+    wire_header_encode(&report->header, WIRE_MSG_REPORT, out);
+    wire_put_u32(out + WIRE_HEADER_SIZE, report->interval_ms);
+    wire_put_u32(out + WIRE_HEADER_SIZE + 4, report->messages);
+    wire_put_u32(out + WIRE_HEADER_SIZE + 8, report->lost);
+    wire_put_u32(out + WIRE_HEADER_SIZE + 12, report->bytes);
+    return WIRE_REPORT_SIZE;
+}
+
+static inline bool wire_report_decode(const uint8_t* in, size_t length, WireReport* report) {
+    if (length != WIRE_REPORT_SIZE || !wire_header_decode(in, length, &report->header) ||
+        report->header.kind != WIRE_MSG_REPORT) {
+        return false;
+    }
+    report->interval_ms = wire_get_u32(in + WIRE_HEADER_SIZE);
+    report->messages = wire_get_u32(in + WIRE_HEADER_SIZE + 4);
+    report->lost = wire_get_u32(in + WIRE_HEADER_SIZE + 8);
+    report->bytes = wire_get_u32(in + WIRE_HEADER_SIZE + 12);
+    return report->interval_ms > 0;
+}
+
+// ---------------------------------------------------------------------------
+// Frame reassembly from CHUNK messages, with FEC repair and NACK
+// generation (chunk_reassembly.c)
+// ---------------------------------------------------------------------------
+
+#define WIRE_REASSEMBLY_SLOTS 16        // Frames in flight at once
+// Incomplete frames are dropped at this age: the sender's last resends
+// have had time to arrive, and anything later would only be shown late
+#define WIRE_FRAME_TIMEOUT_MS (WIRE_REPAIR_DEADLINE_MS + WIRE_NACK_RETRY_MS)
+
+typedef struct {
+    uint8_t* data;              // Frame bytes, chunk i at i * chunk_size
+    uint8_t* parity;            // Received parity payloads, group g at g * chunk_size
+    uint8_t have[WIRE_MAX_CHUNKS / 8];
+    uint8_t have_parity[WIRE_MAX_CHUNKS / 8];
+    uint32_t frame_num;         // 0 = slot unused
+    uint32_t frame_length;
+    uint16_t total_chunks;
+    uint16_t chunk_size;
+    uint16_t fec_group;
+    int chunks_received;        // Data chunks placed, received or rebuilt
+    int chunks_rebuilt;
+    bool complete;
+    bool timed_out;             // Dropped incomplete; its late chunks are ignored
+    uint64_t first_arrival_ns;
+    uint64_t last_arrival_ns;
+    uint64_t last_nack_ns;      // 0 = never NACKed
+} WireFrameSlot;
+
+typedef struct {
+    WireFrameSlot slots[WIRE_REASSEMBLY_SLOTS];
+    long frames_completed;
+    long frames_repaired;       // Completed only thanks to parity
+    long chunks_rebuilt;
+    long frames_abandoned;      // Evicted before all chunks arrived
+    long frames_timed_out;      // Dropped incomplete after WIRE_FRAME_TIMEOUT_MS
+    long frames_nack_repaired;  // Completed after at least one NACK
+    long nacks_sent;
+    long chunks_requested;
+} WireReassembler;
+
+bool wire_reassembler_init(WireReassembler* reassembler);
+void wire_reassembler_free(WireReassembler* reassembler);
+const WireFrameSlot* wire_reassembler_add(WireReassembler* reassembler,
+                                          const uint8_t* datagram, size_t length,
+                                          uint64_t now_ns);
+bool wire_reassembler_next_nack(WireReassembler* reassembler, uint64_t now_ns, WireNack* nack);
+int wire_reassembler_expire(WireReassembler* reassembler, uint64_t now_ns);
+
+// ---------------------------------------------------------------------------
+// Receiving (chunk_reassembly.c). A sender using UDP segmentation offload
+// hands the kernel runs of equal-sized datagrams in one buffer; with UDP_GRO
+// enabled the receiver gets such runs back whole, in one recvmsg(), and
+// walks them segment by segment. Without it every datagram is read alone.
+// ---------------------------------------------------------------------------
+
+#define WIRE_MAX_SEGMENTS 64            // Datagrams per offloaded send (kernel limit)
+
+bool wire_enable_gro(int sock);
+ssize_t wire_receive(int sock, uint8_t* buffer, size_t size, struct sockaddr_in* from,
+                     size_t* segment_size);
+
+#endif // WIRE_PROTOCOL_H
@@ -8,10 +8,13 @@
 #include <arpa/inet.h>
 #include <ncurses.h>
 #include <time.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <math.h>
 #include "../include/client_structures.h"
+#include "../include/wire_protocol.h"
 
 
 // External C++ OpenCV function
@@ -23,28 +26,23 @@ extern "C" {
 }
 #endif
 
-#define UDP_FRAME_PORT 8889
-#define CHUNK_SIZE 1024
-#define MAX_CHUNKS 200
-
-typedef struct {
-    int frame_num;
-    int chunk_id;
-    int total_chunks;
-    int chunk_size;
-    char data[CHUNK_SIZE];
-} FrameChunk;
-
-typedef struct {
-    char data[MAX_CHUNKS * CHUNK_SIZE];
-    int chunks_received;
-    int total_chunks;
-    bool complete;
-} FrameBuffer;
-
 ClientState client_state;
 char latest_frame_path[256] = "Waiting...";
-FrameBuffer frame_buffers[TOTAL_FRAMES];
+
+// Where the stream comes from: a server we SUBSCRIBE to, or a multicast group
+static struct sockaddr_in server_addr;
+static struct in_addr multicast_group;
+static bool multicast_mode = false;
+static uint8_t stream_feed = 0;      // Server feed this client shows (--feed)
+
+// Timing of the frames being received, frame n in n % WIRE_REASSEMBLY_SLOTS
+// like the reassembler's slots (receiver thread only)
+static FrameTiming frame_timings[WIRE_REASSEMBLY_SLOTS];
+
+static const char* latency_stage_names[LATENCY_STAGES] = {
+    "capture->encode", "encode->send", "send->1st chunk", "1st chunk->recv",
+    "recv->complete", "complete->decode", "decode->display", "capture->display"
+};
 
 // Calculate distance between two GPS coordinates using Haversine formula
 double calculate_distance(double lat1, double lon1, double lat2, double lon2) {
@@ -65,87 +63,417 @@ double calculate_distance(double lat1, double lon1, double lat2, double lon2) {
     return R * c; // Distance in meters
 }
 
-void* udp_receiver_thread(void* arg) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    struct sockaddr_in addr;
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(UDP_PORT);
-    addr.sin_addr.s_addr = INADDR_ANY;
+static void sensor_from_wire(const WireTelemetry* wire, int frame_id, SensorData* sensor) {
+    sensor->frame_number = frame_id;
+    sensor->altitude = wire->altitude;
+    sensor->speed = wire->speed;
+    sensor->latitude = wire->latitude;
+    sensor->longitude = wire->longitude;
+    sensor->timestamp = (time_t)(wire->time_ns / 1000000000ULL);
+    sensor->is_valid = (wire->flags & WIRE_TELEMETRY_VALID) != 0;
+}
+
+// Adds one stage sample; stages with a missing stamp are skipped
+void latency_record(int stage, uint64_t start_ns, uint64_t end_ns) {
+    if (start_ns == 0 || end_ns == 0) return;
+    LatencyHistogram* histogram = &client_state.latency[stage];
+    if (end_ns < start_ns) {
+        histogram->negative++;
+        return;
+    }
+    double ms = (end_ns - start_ns) / 1e6;
+    int bucket = 0;
+    double bound = LATENCY_BUCKET_MIN_MS;
+    while (bucket < LATENCY_BUCKETS - 1 && ms >= bound) {
+        bucket++;
+        bound *= 2;
+    }
+    histogram->counts[bucket]++;
+    histogram->samples++;
+    histogram->sum_ms += ms;
+    if (ms > histogram->max_ms) histogram->max_ms = ms;
+}
+
+// Upper bound of the bucket holding the given quantile (at most the maximum)
+static double latency_quantile_ms(const LatencyHistogram* histogram, double quantile) {
+    long target = (long)ceil(histogram->samples * quantile);
+    long seen = 0;
+    double bound = LATENCY_BUCKET_MIN_MS;
+    for (int i = 0; i < LATENCY_BUCKETS - 1; i++, bound *= 2) {
+        seen += histogram->counts[i];
+        if (seen >= target) break;
+    }
+    return bound < histogram->max_ms ? bound : histogram->max_ms;
+}
+
+// Prints a line per stage and writes every bucket to csv_path
+void latency_report(const char* csv_path) {
+    printf("Frame latency by stage (ms; p50/p99 are bucket upper bounds):\n");
+    printf("  %-18s %7s %8s %8s %8s %8s\n", "stage", "frames", "avg", "p50", "p99", "max");
+    for (int stage = 0; stage < LATENCY_STAGES; stage++) {
+        const LatencyHistogram* histogram = &client_state.latency[stage];
+        printf("  %-18s %7ld", latency_stage_names[stage], histogram->samples);
+        if (histogram->samples > 0) {
+            printf(" %8.2f %8.2f %8.2f %8.2f", histogram->sum_ms / histogram->samples,
+                   latency_quantile_ms(histogram, 0.5), latency_quantile_ms(histogram, 0.99),
+                   histogram->max_ms);
+        }
+        if (histogram->negative > 0) printf("  (%ld negative: clock skew)", histogram->negative);
+        printf("\n");
+    }
+
+    FILE* csv = fopen(csv_path, "w");
+    if (!csv) return;
+    fprintf(csv, "stage,bucket_upper_ms,count\n");
+    for (int stage = 0; stage < LATENCY_STAGES; stage++) {
+        double bound = LATENCY_BUCKET_MIN_MS;
+        for (int i = 0; i < LATENCY_BUCKETS; i++, bound *= 2) {
+            if (i == LATENCY_BUCKETS - 1) {
+                fprintf(csv, "%s,inf,%ld\n", latency_stage_names[stage],
+                        client_state.latency[stage].counts[i]);
+            } else {
+                fprintf(csv, "%s,%.3f,%ld\n", latency_stage_names[stage], bound,
+                        client_state.latency[stage].counts[i]);
+            }
+        }
+    }
+    fclose(csv);
+    printf("Latency histogram written to %s\n", csv_path);
+}
+
+// The timing record of frame_id, started afresh if the slot held another frame
+static FrameTiming* frame_timing(uint32_t frame_id) {
+    FrameTiming* timing = &frame_timings[frame_id % WIRE_REASSEMBLY_SLOTS];
+    if (timing->frame_id != frame_id) {
+        memset(timing, 0, sizeof(*timing));
+        timing->frame_id = frame_id;
+    }
+    return timing;
+}
+
+// Saves a completed frame and hands it to the video player. Of TILES
+// frames only the keyframes are whole pictures, so only they are saved.
+static void publish_frame(const WireFrameSlot* frame) {
+    FrameTiming* timing = frame_timing(frame->frame_num);
+    timing->complete_ns = wire_realtime_ns();
+    latency_record(LATENCY_ENCODE, timing->capture_ns, timing->encode_ns);
+    latency_record(LATENCY_QUEUE, timing->encode_ns, timing->send_ns);
+    latency_record(LATENCY_SEND, timing->send_ns, timing->first_chunk_sent_ns);
+    latency_record(LATENCY_NETWORK, timing->first_chunk_sent_ns, timing->first_chunk_ns);
+    latency_record(LATENCY_TRANSFER, timing->first_chunk_ns, timing->complete_ns);
     
-    bind(sock, (struct sockaddr*)&addr, sizeof(addr));
-    printf("[UDP-Meta] Listening on port %d...\n", UDP_PORT);
+    const uint8_t* jpeg = frame->data;
+    size_t jpeg_length = frame->frame_length;
+    WireTiles tiles;
+    bool tiled = wire_tiles_decode(frame->data, frame->frame_length, &tiles);
+    if (tiled) {
+        jpeg += WIRE_TILES_HEADER_SIZE;
+        jpeg_length -= WIRE_TILES_HEADER_SIZE;
+    }
+    bool key = !tiled || (tiles.flags & WIRE_TILES_KEY);
     
-    while (client_state.system_active) {
-        VideoPacket packet;
-        recv(sock, &packet, sizeof(VideoPacket), 0);
+    char filename[256];
+    snprintf(filename, sizeof(filename), "received_frames/frame_%03u.jpg", frame->frame_num);
+    
+    int fd = key ? open(filename, O_CREAT | O_WRONLY | O_TRUNC, 0644) : -1;
+    if (fd >= 0) {
+        write(fd, jpeg, jpeg_length);
+        close(fd);
+        
+        pthread_mutex_lock(&client_state.data_mutex);
+        snprintf(latest_frame_path, sizeof(latest_frame_path), "%s", filename);
+        pthread_mutex_unlock(&client_state.data_mutex);
+    }
+    
+    // A frame completed by a late repair after a newer one was shown would
+    // step the picture back; it only counts if it is a keyframe still needed
+    LatestFrame* latest = &client_state.frame;
+    pthread_mutex_lock(&latest->mutex);
+    uint32_t shown = (uint32_t)latest->frame_id;
+    bool behind = shown > frame->frame_num && shown - frame->frame_num < 2 * WIRE_REASSEMBLY_SLOTS;
+    if (tiled && key && (!behind || frame->frame_num > latest->key_frame_id)) {
+        memcpy(latest->key, frame->data, frame->frame_length);
+        latest->key_length = frame->frame_length;
+        latest->key_frame_id = frame->frame_num;
+    }
+    if (behind) {
+        client_state.frames_out_of_order++;
+    } else {
+        memcpy(latest->data, frame->data, frame->frame_length);
+        latest->length = frame->frame_length;
+        latest->frame_id = (int)frame->frame_num;
+        latest->timing = *timing;
+        latest->published++;
+        pthread_cond_signal(&latest->ready);
+    }
+    pthread_mutex_unlock(&latest->mutex);
+}
+
+// Dispatches one datagram of the stream by message kind
+static void handle_stream_message(const uint8_t* datagram, size_t length,
+                                  WireReassembler* reassembler, uint64_t now) {
+    WireHeader header;
+    if (!wire_header_decode(datagram, length, &header)) return;
+    
+    if (header.kind == WIRE_MSG_META) {
+        WireMeta meta;
+        if (!wire_meta_decode(datagram, length, &meta)) return;
         
         pthread_mutex_lock(&client_state.data_mutex);
-        client_state.latest_packet = packet;
+        VideoPacket* packet = &client_state.latest_packet;
+        packet->frame_id = (int)header.frame_id;
+        packet->frame_width = meta.width;
+        packet->frame_height = meta.height;
+        sensor_from_wire(&meta.telemetry, packet->frame_id, &packet->sensor);
         client_state.total_received++;
         client_state.new_data = true;
         pthread_mutex_unlock(&client_state.data_mutex);
+        
+        FrameTiming* timing = frame_timing(header.frame_id);
+        timing->capture_ns = meta.capture_ns;
+        timing->encode_ns = meta.encode_ns;
+        timing->send_ns = header.timestamp_ns;
+    } else if (header.kind == WIRE_MSG_ALERT) {
+        WireAlert alert;
+        if (!wire_alert_decode(datagram, length, &alert)) return;
+        
+        pthread_mutex_lock(&client_state.data_mutex);
+        AlertInfo* latest = &client_state.latest_alert;
+        latest->frame_id = (int)header.frame_id;
+        snprintf(latest->type, sizeof(latest->type), "%s", alert.type);
+        latest->confidence = alert.confidence;
+        sensor_from_wire(&alert.telemetry, latest->frame_id, &latest->sensor);
+        client_state.total_alerts++;
+        pthread_mutex_unlock(&client_state.data_mutex);
+    } else if (header.kind == WIRE_MSG_CHUNK) {
+        FrameTiming* timing = frame_timing(header.frame_id);
+        if (timing->first_chunk_ns == 0) {
+            timing->first_chunk_ns = wire_realtime_ns();
+            timing->first_chunk_sent_ns = header.timestamp_ns;
+        }
+        
+        // Chunks are reassembled (and lost ones rebuilt from parity) in chunk_reassembly.c
+        const WireFrameSlot* frame = wire_reassembler_add(reassembler, datagram, length, now);
+        if (frame) publish_frame(frame);
     }
-    
-    close(sock);
-    return NULL;
 }
 
-void* udp_frame_receiver_thread(void* arg) {
+// Joins (renews) or, with WIRE_SUBSCRIBE_LEAVE, leaves the server's stream.
+// The server acts on it only with the cookie it last sent us echoed.
+static void send_subscribe(int sock, uint8_t flags, uint64_t cookie, uint32_t* sequence) {
+    WireSubscribe subscribe;
+    memset(&subscribe, 0, sizeof(subscribe));
+    subscribe.header.sequence = ++*sequence;
+    subscribe.header.timestamp_ns = wire_realtime_ns();
+    subscribe.header.source_id = stream_feed;
+    subscribe.flags = flags;
+    subscribe.cookie = cookie;
+    uint8_t message[WIRE_SUBSCRIBE_SIZE];
+    size_t length = wire_subscribe_encode(&subscribe, message);
+    sendto(sock, message, length, 0, (struct sockaddr*)&server_addr, sizeof(server_addr));
+}
+
+// What reached us over the last interval_ns, for the sender's rate control
+static void send_report(int sock, const struct sockaddr_in* to, uint64_t interval_ns,
+                        long messages, long lost, long long bytes, uint32_t* sequence) {
+    WireReport report;
+    memset(&report, 0, sizeof(report));
+    report.header.sequence = ++*sequence;
+    report.header.timestamp_ns = wire_realtime_ns();
+    report.header.source_id = stream_feed;
+    report.interval_ms = (uint32_t)(interval_ns / 1000000ULL);
+    report.messages = (uint32_t)messages;
+    report.lost = (uint32_t)lost;
+    report.bytes = (uint32_t)bytes;
+    uint8_t message[WIRE_REPORT_SIZE];
+    size_t length = wire_report_encode(&report, message);
+    sendto(sock, message, length, 0, (const struct sockaddr*)to, sizeof(*to));
+}
+
+// The one receiver: every message of the server's stream arrives on UDP_PORT.
+// epoll waits on the socket and a WIRE_NACK_DELAY_MS timer, so frames whose
+// chunks stopped coming are NACKed even while nothing arrives; the same tick
+// renews the subscription every WIRE_SUBSCRIBE_INTERVAL_MS (echoing the
+// server's cookie; multicast receivers just join the group and never
+// subscribe) and REPORTs what got through every WIRE_REPORT_INTERVAL_MS,
+// multicast receivers included.
+void* stream_receiver_thread(void* arg) {
     int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int reuse = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
     struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
     addr.sin_family = AF_INET;
-    addr.sin_port = htons(UDP_FRAME_PORT);
+    addr.sin_port = htons(UDP_PORT);
     addr.sin_addr.s_addr = INADDR_ANY;
     
-    bind(sock, (struct sockaddr*)&addr, sizeof(addr));
-    printf("[UDP-Frame] Listening on port %d...\n", UDP_FRAME_PORT);
+    if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("[UDP-Stream] Bind failed");
+        close(sock);
+        return NULL;
+    }
+    printf("[UDP-Stream] Listening on port %d...\n", UDP_PORT);
+    if (wire_enable_gro(sock)) {
+        printf("[UDP-Stream] ✓ UDP_GRO enabled: chunk runs arrive in one read\n");
+    }
+    
+    if (multicast_mode) {
+        struct ip_mreq membership;
+        membership.imr_multiaddr = multicast_group;
+        membership.imr_interface.s_addr = htonl(INADDR_ANY);
+        if (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0) {
+            perror("[UDP-Stream] Cannot join multicast group");
+            close(sock);
+            return NULL;
+        }
+        printf("[UDP-Stream] ✓ Joined multicast group %s\n", inet_ntoa(multicast_group));
+    }
     
     system("mkdir -p received_frames");
     
-    for (int i = 0; i < TOTAL_FRAMES; i++) {
-        frame_buffers[i].chunks_received = 0;
-        frame_buffers[i].total_chunks = 0;
-        frame_buffers[i].complete = false;
+    static WireReassembler reassembler;
+    if (!wire_reassembler_init(&reassembler)) {
+        printf("[UDP-Stream] Error: Cannot allocate reassembly buffers\n");
+        close(sock);
+        return NULL;
     }
     
+    int tick = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    struct itimerspec period;
+    period.it_interval.tv_sec = 0;
+    period.it_interval.tv_nsec = WIRE_NACK_DELAY_MS * 1000000L;
+    period.it_value = period.it_interval;
+    timerfd_settime(tick, 0, &period, NULL);
+    
+    int poller = epoll_create1(0);
+    struct epoll_event watch;
+    memset(&watch, 0, sizeof(watch));
+    watch.events = EPOLLIN;
+    watch.data.fd = sock;
+    epoll_ctl(poller, EPOLL_CTL_ADD, sock, &watch);
+    watch.data.fd = tick;
+    epoll_ctl(poller, EPOLL_CTL_ADD, tick, &watch);
+    
+    static uint8_t datagram[WIRE_MAX_DATAGRAM];
+    // NACKs go wherever the stream comes from
+    struct sockaddr_in source_addr;
+    bool source_known = false;
+    uint32_t next_sequence = 0;
+    uint32_t control_sequence = 0;     // Our SUBSCRIBEs, NACKs and REPORTs
+    long messages = 0;
+    long messages_missed = 0;
+    long long bytes = 0;
+    uint64_t last_subscribe = 0;
+    uint64_t cookie = 0;                // From the server's last COOKIE
+    // Totals at the last REPORT; each one covers what came since
+    uint64_t last_report = wire_now_ns();
+    long reported_messages = 0;
+    long reported_missed = 0;
+    long long reported_bytes = 0;
     while (client_state.system_active) {
-        FrameChunk chunk;
-        ssize_t received = recv(sock, &chunk, sizeof(FrameChunk), 0);
+        // The server forgets us WIRE_SUBSCRIBE_LEASE_MS after the last renewal
+        if (!multicast_mode &&
+            wire_now_ns() - last_subscribe >= WIRE_SUBSCRIBE_INTERVAL_MS * 1000000ULL) {
+            send_subscribe(sock, 0, cookie, &control_sequence);
+            last_subscribe = wire_now_ns();
+        }
         
-        if (received > 0) {
-            int frame_idx = chunk.frame_num - 1;
-            if (frame_idx >= 0 && frame_idx < TOTAL_FRAMES) {
-                FrameBuffer* fb = &frame_buffers[frame_idx];
-                
-                if (fb->total_chunks == 0) {
-                    fb->total_chunks = chunk.total_chunks;
-                }
-                
-                int offset = chunk.chunk_id * CHUNK_SIZE;
-                memcpy(fb->data + offset, chunk.data, chunk.chunk_size);
-                fb->chunks_received++;
-                
-                if (fb->chunks_received >= fb->total_chunks && !fb->complete) {
-                    fb->complete = true;
-                    
-                    char filename[256];
-                    snprintf(filename, sizeof(filename), "received_frames/frame_%03d.jpg", chunk.frame_num);
-                    
-                    int fd = open(filename, O_CREAT | O_WRONLY | O_TRUNC, 0644);
-                    if (fd >= 0) {
-                        int total_size = (fb->total_chunks - 1) * CHUNK_SIZE + chunk.chunk_size;
-                        write(fd, fb->data, total_size);
-                        close(fd);
-                        
-                        pthread_mutex_lock(&client_state.data_mutex);
-                        snprintf(latest_frame_path, sizeof(latest_frame_path), "%s", filename);
-                        pthread_mutex_unlock(&client_state.data_mutex);
+        struct epoll_event events[2];
+        int ready = epoll_wait(poller, events, 2, 100);
+        
+        for (int i = 0; i < ready; i++) {
+            if (events[i].data.fd == tick) {
+                uint64_t expirations;
+                read(tick, &expirations, sizeof(expirations));
+                continue;
+            }
+            
+            // With GRO one read may hold a run of datagrams, segment bytes each
+            struct sockaddr_in from;
+            ssize_t received;
+            size_t segment;
+            while ((received = wire_receive(sock, datagram, sizeof(datagram), &from, &segment)) > 0) {
+                uint64_t now = wire_now_ns();
+                for (size_t offset = 0; offset < (size_t)received; offset += segment) {
+                    const uint8_t* message = datagram + offset;
+                    size_t length = (size_t)received - offset < segment ?
+                                    (size_t)received - offset : segment;
+                    // The server wants its cookie echoed before it streams
+                    // to us (or renews us); it is not part of the stream
+                    WireCookie reply;
+                    if (!multicast_mode && wire_cookie_decode(message, length, &reply) &&
+                        reply.header.source_id == stream_feed &&
+                        from.sin_addr.s_addr == server_addr.sin_addr.s_addr &&
+                        from.sin_port == server_addr.sin_port) {
+                        bool first = cookie == 0;
+                        cookie = reply.cookie;
+                        if (first) printf("[UDP-Stream] ✓ Server cookie received, subscribing\n");
+                        send_subscribe(sock, 0, cookie, &control_sequence);
+                        last_subscribe = wire_now_ns();
+                        continue;
+                    }
+                    // Fixed targets and multicast groups get every feed's
+                    // stream; the others' messages are not ours to count
+                    WireHeader header;
+                    if (wire_header_decode(message, length, &header)) {
+                        if (header.source_id != stream_feed) continue;
+                        // Every message, whatever its kind, takes the next sequence
+                        // number; resent chunks (sequence 0) are outside the count
+                        if (next_sequence != 0 && header.sequence > next_sequence) {
+                            messages_missed += header.sequence - next_sequence;
+                        }
+                        if (header.sequence != 0 && header.sequence >= next_sequence) {
+                            next_sequence = header.sequence + 1;
+                        }
+                        messages++;
+                        bytes += length;
+                        source_addr = from;
+                        source_known = true;
                     }
+                    handle_stream_message(message, length, &reassembler, now);
                 }
             }
         }
+        
+        // Ask the sender again for chunks that neither arrived nor could be
+        // rebuilt; frames past all hope of repair are given up
+        uint64_t now = wire_now_ns();
+        wire_reassembler_expire(&reassembler, now);
+        WireNack nack;
+        while (source_known && wire_reassembler_next_nack(&reassembler, now, &nack)) {
+            uint8_t message[WIRE_NACK_MAX_SIZE];
+            nack.header.sequence = ++control_sequence;
+            nack.header.timestamp_ns = wire_realtime_ns();
+            nack.header.source_id = stream_feed;
+            size_t length = wire_nack_encode(&nack, message);
+            sendto(sock, message, length, 0, (struct sockaddr*)&source_addr, sizeof(source_addr));
+        }
+        
+        // The sender fits its frames to what the worst receiver gets through
+        if (source_known && now - last_report >= WIRE_REPORT_INTERVAL_MS * 1000000ULL) {
+            send_report(sock, &source_addr, now - last_report, messages - reported_messages,
+                        messages_missed - reported_missed, bytes - reported_bytes,
+                        &control_sequence);
+            last_report = now;
+            reported_messages = messages;
+            reported_missed = messages_missed;
+            reported_bytes = bytes;
+        }
     }
+    if (!multicast_mode) send_subscribe(sock, WIRE_SUBSCRIBE_LEAVE, cookie, &control_sequence);
     
+    printf("[UDP-Stream] %ld messages (%ld never arrived) | %d meta, %d alerts\n",
+           messages, messages_missed, client_state.total_received, client_state.total_alerts);
+    printf("[UDP-Stream] %ld frames complete (%ld repaired by FEC, %ld chunks rebuilt; "
+           "%ld after NACKs), %ld timed out, %ld incomplete | %ld NACKs for %ld chunks | "
+           "%ld completed behind a newer frame\n",
+           reassembler.frames_completed, reassembler.frames_repaired, reassembler.chunks_rebuilt,
+           reassembler.frames_nack_repaired, reassembler.frames_timed_out,
+           reassembler.frames_abandoned, reassembler.nacks_sent, reassembler.chunks_requested,
+           client_state.frames_out_of_order);
+    wire_reassembler_free(&reassembler);
+    close(poller);
+    close(tick);
     close(sock);
     return NULL;
 }
@@ -205,6 +533,7 @@ void* ui_thread(void* arg) {
     while (client_state.system_active) {
         pthread_mutex_lock(&client_state.data_mutex);
         VideoPacket pkt = client_state.latest_packet;
+        AlertInfo alert = client_state.latest_alert;
         int total = client_state.total_received;
         char frame_path[256];
         strcpy(frame_path, latest_frame_path);
@@ -244,6 +573,13 @@ void* ui_thread(void* arg) {
         mvprintw(9, 4, "GPS: %.6f, %.6f", pkt.sensor.latitude, pkt.sensor.longitude);
         mvprintw(10, 4, "Saved Frame: %s", frame_path);
         attroff(COLOR_PAIR(2));
+        
+        if (alert.frame_id > 0) {
+            attron(COLOR_PAIR(3) | A_BOLD);
+            mvprintw(11, 4, "Last Alert: %s at frame %d (%.0f%% confidence)",
+                     alert.type, alert.frame_id, alert.confidence * 100.0);
+            attroff(COLOR_PAIR(3) | A_BOLD);
+        }
 
         // Obstacle Zone Information
         if (total >= OBSTACLE_FRAME_START) {
@@ -348,16 +684,56 @@ void* ui_thread(void* arg) {
     return NULL;
 }
 
-int main() {
+int main(int argc, char** argv) {
+    // aviation_client [SERVER_IP] [--multicast GROUP] [--feed N]
+    const char* server_ip = SERVER_IP;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--multicast") == 0 && i + 1 < argc) {
+            multicast_mode = inet_pton(AF_INET, argv[++i], &multicast_group) == 1 &&
+                             IN_MULTICAST(ntohl(multicast_group.s_addr));
+            if (!multicast_mode) {
+                fprintf(stderr, "Not a multicast group: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--feed") == 0 && i + 1 < argc) {
+            int feed = atoi(argv[++i]);
+            if (feed < 0 || feed > 255) {
+                fprintf(stderr, "Not a feed number: %s\n", argv[i]);
+                return 1;
+            }
+            stream_feed = (uint8_t)feed;
+        } else if (argv[i][0] != '-') {
+            server_ip = argv[i];
+        } else {
+            printf("Usage: %s [SERVER_IP] [--multicast GROUP] [--feed N]\n", argv[0]);
+            return 1;
+        }
+    }
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(UDP_SERVER_PORT);
+    if (inet_pton(AF_INET, server_ip, &server_addr.sin_addr) != 1) {
+        fprintf(stderr, "Invalid server address: %s\n", server_ip);
+        return 1;
+    }
+    
     printf("\n***********************************************************\n");
     printf("    AVIATION CLIENT - OPENCV LIVE STREAM               \n");
-    printf("    Ports: 8888 (meta) + 8889 (frames) + 9000 (video) \n");
+    printf("    Port: 8888 (meta + alerts + frames, one stream) \n");
+    if (multicast_mode) {
+        printf("    Source: multicast group %s\n", inet_ntoa(multicast_group));
+    } else {
+        printf("    Source: subscribed to %s:%d\n", server_ip, UDP_SERVER_PORT);
+    }
+    printf("    Feed: %d%s\n", stream_feed, stream_feed == 0 ? " (primary)" : "");
     printf("***********************************************************\n\n");
     
     client_state.system_active = true;
     client_state.new_data = false;
     client_state.total_received = 0;
     pthread_mutex_init(&client_state.data_mutex, NULL);
+    pthread_mutex_init(&client_state.frame.mutex, NULL);
+    pthread_cond_init(&client_state.frame.ready, NULL);
     
     client_state.latest_packet.frame_id = 0;
     client_state.latest_packet.frame_width = 320;
@@ -365,9 +741,8 @@ int main() {
     
     printf("Creating receiver threads...\n");
     
-    pthread_t udp_thread, frame_thread, video_player, ui;
-    pthread_create(&udp_thread, NULL, udp_receiver_thread, NULL);
-    pthread_create(&frame_thread, NULL, udp_frame_receiver_thread, NULL);
+    pthread_t stream_thread, video_player, ui;
+    pthread_create(&stream_thread, NULL, stream_receiver_thread, NULL);
     pthread_create(&video_player, NULL, opencv_video_player_thread, NULL);
     pthread_create(&ui, NULL, ui_thread, NULL);
     
@@ -377,12 +752,19 @@ int main() {
     
     pthread_join(ui, NULL);
     client_state.system_active = false;
-    pthread_join(udp_thread, NULL);
-    pthread_join(frame_thread, NULL);
+    pthread_join(stream_thread, NULL);
+    pthread_mutex_lock(&client_state.frame.mutex);
+    pthread_cond_broadcast(&client_state.frame.ready);
+    pthread_mutex_unlock(&client_state.frame.mutex);
     pthread_join(video_player, NULL);
     
+    pthread_cond_destroy(&client_state.frame.ready);
+    pthread_mutex_destroy(&client_state.frame.mutex);
     pthread_mutex_destroy(&client_state.data_mutex);
     
+    printf("\n");
+    latency_report(LATENCY_CSV_PATH);
+    
     printf("\n***********************************************************\n");
     printf("    AVIATION CLIENT SHUTDOWN COMPLETE                   \n");
     printf("    Total packets received: %-28d\n", client_state.total_received);
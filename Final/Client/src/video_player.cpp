@@ -1,43 +1,121 @@
 #include <opencv2/opencv.hpp>
 #include <iostream>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <unistd.h>
 #include <cstring>
+#include <algorithm>
 #include <ctime>
 #include <pthread.h>
 #include "../include/client_structures.h"
-#define UDP_VIDEO_PORT 9000
-#define BUFFER_SIZE 65536
 
 // C linkage for pthread compatibility
 extern "C" {
     void* opencv_video_player_thread(void* arg);
 }
 
-void* opencv_video_player_thread(void* arg) {
-    // Create UDP socket
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-        std::cerr << "[OpenCV] ERROR: Socket creation failed" << std::endl;
-        return nullptr;
+// The keyframe TILES deltas are drawn over (see wire_protocol.h)
+typedef struct {
+    cv::Mat key;
+    uint32_t key_id;                // 0 = none yet
+    std::vector<uchar> pending;     // Keyframe taken from the receiver, not decoded yet
+    uint32_t pending_id;
+    long dropped;                   // Deltas whose keyframe never reached us
+} TileCanvas;
+
+static cv::Mat decode_jpeg(const uchar* data, size_t length) {
+    return cv::imdecode(cv::Mat(1, (int)length, CV_8UC1, (void*)data), cv::IMREAD_COLOR);
+}
+
+// Waits up to 100 ms for a frame newer than *seen and copies it out, with
+// the receiver's last keyframe if the canvas does not have that one yet
+static bool take_latest_frame(long* seen, std::vector<uchar>& data, int* frame_id,
+                              FrameTiming* timing, TileCanvas* canvas) {
+    LatestFrame* latest = &client_state.frame;
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += 100000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_nsec -= 1000000000L;
+        deadline.tv_sec++;
     }
     
-    // Configure socket address
-    struct sockaddr_in addr;
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(UDP_VIDEO_PORT);
-    addr.sin_addr.s_addr = INADDR_ANY;
+    pthread_mutex_lock(&latest->mutex);
+    while (latest->published == *seen && client_state.system_active) {
+        if (pthread_cond_timedwait(&latest->ready, &latest->mutex, &deadline) != 0) break;
+    }
+    bool fresh = latest->published != *seen;
+    if (fresh) {
+        data.assign(latest->data, latest->data + latest->length);
+        *frame_id = latest->frame_id;
+        *timing = latest->timing;
+        *seen = latest->published;
+        uint32_t key_id = latest->key_frame_id;
+        if (key_id != 0 && key_id != (uint32_t)latest->frame_id &&
+            key_id != canvas->key_id && key_id != canvas->pending_id) {
+            canvas->pending.assign(latest->key, latest->key + latest->key_length);
+            canvas->pending_id = key_id;
+        }
+    }
+    pthread_mutex_unlock(&latest->mutex);
+    return fresh;
+}
+
+// A plain JPEG is decoded as it is. A TILES keyframe is decoded and kept;
+// a delta is drawn over a copy of its keyframe, or is dropped (empty Mat)
+// if that keyframe never arrived.
+static cv::Mat decode_frame(const std::vector<uchar>& data, TileCanvas* canvas) {
+    WireTiles tiles;
+    if (!wire_tiles_decode(data.data(), data.size(), &tiles)) {
+        return cv::imdecode(data, cv::IMREAD_COLOR);
+    }
+    if (tiles.flags & WIRE_TILES_KEY) {
+        canvas->key = decode_jpeg(data.data() + WIRE_TILES_HEADER_SIZE,
+                                  data.size() - WIRE_TILES_HEADER_SIZE);
+        canvas->key_id = canvas->key.empty() ? 0 : tiles.reference;
+        return canvas->key.clone();
+    }
     
-    // Bind socket
-    if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-        std::cerr << "[OpenCV] ERROR: Bind failed on port " << UDP_VIDEO_PORT << std::endl;
-        close(sock);
-        return nullptr;
+    if (canvas->key_id != tiles.reference && canvas->pending_id == tiles.reference) {
+        canvas->key = decode_jpeg(canvas->pending.data() + WIRE_TILES_HEADER_SIZE,
+                                  canvas->pending.size() - WIRE_TILES_HEADER_SIZE);
+        canvas->key_id = canvas->key.empty() ? 0 : tiles.reference;
     }
+    if (canvas->key_id != tiles.reference) {
+        canvas->dropped++;
+        return cv::Mat();
+    }
+    
+    cv::Mat frame = canvas->key.clone();
+    const uchar* bitmap = data.data() + WIRE_TILES_HEADER_SIZE;
+    size_t atlas_at = WIRE_TILES_HEADER_SIZE + wire_tiles_bitmap_size(&tiles);
+    int total = tiles.columns * tiles.rows;
+    int marked = 0;
+    for (int t = 0; t < total; t++) {
+        if (wire_tiles_marked(bitmap, t)) marked++;
+    }
+    if (marked == 0) return frame;
     
-    std::cout << "[OpenCV] ✓ Video player listening on port " << UDP_VIDEO_PORT << std::endl;
+    cv::Mat atlas = decode_jpeg(data.data() + atlas_at, data.size() - atlas_at);
+    if (atlas.empty()) return cv::Mat();
+    int size = tiles.tile_size;
+    int atlas_columns = marked < tiles.columns ? marked : tiles.columns;
+    for (int t = 0, k = 0; t < total; t++) {
+        if (!wire_tiles_marked(bitmap, t)) continue;
+        int x = (t % tiles.columns) * size;
+        int y = (t / tiles.columns) * size;
+        cv::Rect to(x, y, std::min(size, frame.cols - x), std::min(size, frame.rows - y));
+        cv::Rect from((k % atlas_columns) * size, (k / atlas_columns) * size, to.width, to.height);
+        k++;
+        if (to.width <= 0 || to.height <= 0 ||
+            from.x + from.width > atlas.cols || from.y + from.height > atlas.rows) {
+            continue;
+        }
+        atlas(from).copyTo(frame(to));
+    }
+    return frame;
+}
+
+void* opencv_video_player_thread(void* arg) {
+    // Frames come from the stream receiver once reassembled; the player
+    // has no socket of its own
     std::cout << "[OpenCV] ✓ Waiting for video stream from server..." << std::endl;
     
     // Create OpenCV window
@@ -46,15 +124,20 @@ void* opencv_video_player_thread(void* arg) {
     
     int frame_count = 0;
     bool first_frame = true;
+    long seen = 0;
+    std::vector<uchar> data;
+    TileCanvas canvas;
+    canvas.key_id = 0;
+    canvas.pending_id = 0;
+    canvas.dropped = 0;
     
-    while (true) {
-        char buffer[BUFFER_SIZE];
-        ssize_t received = recv(sock, buffer, BUFFER_SIZE, 0);
-        
-        if (received > 0) {
-            // Decode JPEG image from UDP packet
-            std::vector<uchar> data(buffer, buffer + received);
-            cv::Mat frame = cv::imdecode(data, cv::IMREAD_COLOR);
+    while (client_state.system_active) {
+        int frame_id = 0;
+        FrameTiming timing;
+        if (take_latest_frame(&seen, data, &frame_id, &timing, &canvas)) {
+            // Decode the reassembled JPEG, or draw its tiles over their keyframe
+            cv::Mat frame = decode_frame(data, &canvas);
+            timing.decoded_ns = wire_realtime_ns();
             
             if (!frame.empty()) {
                 frame_count++;
@@ -74,7 +157,7 @@ void* opencv_video_player_thread(void* arg) {
                 
                 // Add frame counter
                 char frame_text[50];
-                sprintf(frame_text, "Frame: %d", frame_count);
+                sprintf(frame_text, "Frame: %d", frame_id);
                 cv::putText(frame, frame_text, 
                            cv::Point(10, 60), 
                            cv::FONT_HERSHEY_SIMPLEX, 
@@ -94,8 +177,8 @@ void* opencv_video_player_thread(void* arg) {
                            cv::Scalar(255, 255, 0),  // Yellow
                            1);
                 
-                // Add alert for obstacle frames (80-81)
-                if (frame_count >= OBSTACLE_FRAME_START && frame_count <= OBSTACLE_FRAME_END) {
+                // Add alert for obstacle frames
+                if (frame_id >= OBSTACLE_FRAME_START && frame_id <= OBSTACLE_FRAME_END) {
                     cv::putText(frame, "!! OBSTACLE DETECTED !!", 
                                cv::Point(10, 100), 
                                cv::FONT_HERSHEY_SIMPLEX, 
@@ -104,11 +187,16 @@ void* opencv_video_player_thread(void* arg) {
                                2);
                 }
                 
-                // Display the frame
+                // Display the frame; it is on screen once waitKey() has run the event loop
                 cv::imshow("Aviation Live Stream", frame);
                 
                 // Check for user input (q or ESC to quit)
                 int key = cv::waitKey(1) & 0xFF;
+                timing.displayed_ns = wire_realtime_ns();
+                latency_record(LATENCY_DECODE, timing.complete_ns, timing.decoded_ns);
+                latency_record(LATENCY_DISPLAY, timing.decoded_ns, timing.displayed_ns);
+                latency_record(LATENCY_TOTAL, timing.capture_ns, timing.displayed_ns);
+                
                 if (key == 'q' || key == 27) {
                     std::cout << "[OpenCV] User quit video window (pressed 'q' or ESC)" << std::endl;
                     break;
@@ -119,9 +207,12 @@ void* opencv_video_player_thread(void* arg) {
     
     // Cleanup
     cv::destroyAllWindows();
-    close(sock);
     std::cout << "[OpenCV] Video window closed cleanly" << std::endl;
     std::cout << "[OpenCV] Total frames displayed: " << frame_count << std::endl;
+    if (canvas.dropped > 0) {
+        std::cout << "[OpenCV] Tile deltas dropped (keyframe missing): " << canvas.dropped
+                  << std::endl;
+    }
     
     return nullptr;
 }
@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <semaphore.h>
@@ -14,6 +15,7 @@
 #include <signal.h>
 #include <time.h>
 #include <arpa/inet.h>
+#include "wire_protocol.h"
 
 // Configuration constants - UPDATED FOR 240 FRAMES
 #define FPS 8
@@ -25,9 +27,98 @@
 // Use absolute path to avoid GStreamer issues
 #define VIDEO_PATH "/home/sys1/Documents/P.roject/server/resources/flight_feed.mp4"
 #define FRAMES_DIR "/home/sys1/Documents/P.roject/server/resources/frames"
+#define FRAME_ARCHIVE_PATH "resources/frames/frames.pack"
+#define FRAME_ARCHIVE_MAGIC 0x4B415046  // "FPAK"
+#define FRAME_ARCHIVE_VERSION 3
+#define FRAME_WIDTH 320
+#define FRAME_HEIGHT 240
 
-#define UDP_PORT 8888
-#define CLIENT_IP "192.168.1.110"
+// Renditions stored per frame in the archive, smallest first
+#define MAX_RENDITIONS 4
+#define RENDITION_COUNT 3
+#define RENDITION_WIDTHS { 160, 320, 640 }
+#define RENDITION_HEIGHTS { 120, 240, 480 }
+#define DEFAULT_RENDITION 1        // 320x240
+
+// Live ingest (--live): capture thread -> shared-memory ring -> senders
+#define RING_SHM_NAME "/aviation_ring"
+#define LIVE_RING_SLOTS 32
+#define LIVE_SLOT_BYTES 65536
+#define LIVE_MAX_FRAMES 0          // 0 = run until shutdown
+#define LIVE_SOURCE_VIDEO 0
+#define LIVE_SOURCE_SYNTHETIC 1
+#define LIVE_RAW_SLOTS 8           // Newest frames also kept raw for the stream encoder
+#define LIVE_RAW_FRAME_BYTES (FRAME_WIDTH * FRAME_HEIGHT * 3)
+
+// Multi-source ingest (--sources K): one ring and sensor timeline per feed,
+// all feeds served by one pool of capture workers
+#define MAX_SOURCES 8
+#define CAPTURE_POOL_WORKERS 0     // 0 = one per core, capped at the source count
+#define BENCH_SOURCE_SECONDS 3     // Run time per K in --bench-sources
+
+// Frame cache shared by the frame sender and dashboard
+#define FRAME_CACHE_SLOTS 64       // Window a slow consumer may lag the fastest by
+#define FRAME_CACHE_SLOT_BYTES LIVE_SLOT_BYTES
+#define FRAME_CACHE_PREFETCH 8     // Frames loaded ahead of the playback cursor
+#define FRAME_CACHE_WIDTH 320      // Archive rendition held in the cache (stream, web)
+
+#define UDP_PORT 8888              // Client port of the one outgoing stream
+#define UDP_SERVER_PORT 8887       // Server port: subscriptions and NACKs arrive here
+
+// Subscribers (see subscribers.c): clients that sent SUBSCRIBE, plus fixed
+// --client / --multicast targets
+#define MAX_SUBSCRIBERS 128
+#define MAX_STREAM_TARGETS 8
+#define SUBSCRIBER_MAX_SEND_FAILURES 64  // Sends refused in a row before a subscriber is dropped
+#define SUBSCRIBE_COOKIE_EPOCH_MS 30000  // A SUBSCRIBE cookie is good for one to two of these
+#define MULTICAST_TTL 1            // Hops a multicast stream may cross
+#define SEND_BATCH_MESSAGES 256    // Datagrams per sendmmsg() call when fanning out
+
+// Frame chunks of the stream, see chunk_sender.c
+#define CHUNK_PAYLOAD_SIZE 0                // Payload bytes per chunk, 0 = fit the path MTU
+#define CHUNK_PATH_MTU 1500                 // Assumed when the path MTU cannot be probed
+#define CHUNK_SIZE 1024                     // Padded chunk of the old format (--bench-chunks)
+#define CHUNK_BATCH 16                      // Chunks per sendmmsg() call
+#define CHUNK_SEGMENT_OFFLOAD 1             // Hand the kernel runs of chunks (UDP_SEGMENT) if it can
+#define CHUNK_FEC_GROUP 8                   // Data chunks per XOR parity chunk (1/N overhead), 0 = off
+#define REPAIR_HISTORY_FRAMES 16            // Sent frames kept for NACKed resends
+#define REPAIR_MAX_RESENDS 32               // Chunks one subscriber can have resent per frame
+
+// Stream pacing (see pacing.c): average rate and burst, in bytes
+#define STREAM_SEND_RATE (8.0 * 1024 * 1024)
+#define STREAM_SEND_BURST (CHUNK_BATCH * (double)CHUNK_PATH_MTU)  // One sendmmsg() batch
+#define PACE_LATE_THRESHOLD_MS 5            // Frames later than this count as slipped
+#define FRAME_TICK_TIMEOUT_MS 100           // Longest a frame clock follower sleeps between checks
+#define BENCH_CHUNK_FRAMES 40
+#define BENCH_CHUNK_FRAME_BYTES 30500        // Not a multiple of any chunk size, like a real JPEG
+#define BENCH_FEC_FRAMES 400
+#define BENCH_FANOUT_FRAMES 20
+#define BENCH_GSO_FRAMES 400
+
+// Bitrate adaptation (see rate_control.c and adaptive_encoder.c): receiver
+// REPORTs set a byte budget, and each frame is re-encoded at the best level
+// of the ladder whose frames fit it
+#define ADAPTIVE_QUALITY 1                  // 0 = send frames as stored
+#define ADAPT_LEVELS 6
+#define ADAPT_QUALITIES { 90, 75, 60, 45, 60, 40 }  // JPEG quality per level
+#define ADAPT_SCALES { 100, 100, 100, 100, 50, 50 } // Percent of the stream size per level
+#define ADAPT_START_LEVEL 1
+#define ADAPT_LOSS_HIGH 0.05                // Reported loss above this cuts the budget
+#define ADAPT_LOSS_LOW 0.01                 // Loss below this lets it grow again
+#define ADAPT_DECREASE 0.7                  // Cut: this times what the receiver got
+#define ADAPT_INCREASE 1.05                 // Growth per report interval
+#define ADAPT_HOLD_MS 2000                  // No growth or step up this soon after a cut
+#define ADAPT_MIN_RATE (16.0 * 1024)        // Floor of the budget, bytes per second
+#define ADAPT_HEADROOM 0.8                  // Budget share for frames (rest: parity, meta, resends)
+#define ADAPT_CACHE_FRAMES 16               // Recent frames kept raw, with their encodes
+
+// Tile delta coding (see adaptive_encoder.c): between keyframes only the
+// tiles that changed since the last keyframe are sent
+#define TILE_DELTA 1                        // 0 = every frame a whole JPEG
+#define TILE_SIZE 16                        // Pixels, a multiple of the JPEG block
+#define TILE_CHANGE_THRESHOLD 3.0           // Mean absolute pixel difference of a changed tile
+#define TILE_KEYFRAME_INTERVAL 16           // Frames from one keyframe to the next (2 s)
+#define TILE_KEYFRAME_SHARE 0.6             // Send a keyframe once this share of tiles changed
 
 // IPC identifiers
 #define SHM_NAME "/aviation_shm"
@@ -43,8 +134,16 @@ typedef struct {
     double longitude;
     time_t timestamp;
     bool is_valid;
+    uint64_t time_ns;           // When the reading was taken (CLOCK_REALTIME ns)
 } SensorData;
 
+// When a frame was captured and encoded (CLOCK_REALTIME ns, 0 = unknown);
+// travels with the frame and goes out in its META message
+typedef struct {
+    uint64_t capture_ns;
+    uint64_t encode_ns;
+} FrameTimes;
+
 // Detection result structure
 typedef struct {
     int frame_number;
@@ -54,20 +153,214 @@ typedef struct {
     SensorData sensor_snapshot;
 } DetectionResult;
 
-// Video packet structure for UDP transmission
+// Packed frame archive written by aviation_monitor: header, index, JPEG payloads
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t frame_count;
+    uint32_t frame_width;
+    uint32_t frame_height;
+    uint32_t fps;
+    uint64_t index_offset;
+    uint64_t payload_offset;
+    uint32_t rendition_count;
+    uint32_t default_rendition;
+    uint32_t rendition_width[MAX_RENDITIONS];
+    uint32_t rendition_height[MAX_RENDITIONS];
+} FrameArchiveHeader;
+
+typedef struct {
+    uint64_t offset[MAX_RENDITIONS];    // Payload offsets from start of file
+    uint32_t length[MAX_RENDITIONS];    // JPEG sizes in bytes
+    SensorData sensor;                  // Sensor record captured with the frame
+} FrameIndexEntry;
+
+// Fixed-size chunk of the old frame chunk format, always padded to CHUNK_SIZE.
+// Only the --bench-chunks baseline still sends it; see wire_protocol.h.
+typedef struct {
+    int frame_num;
+    int chunk_id;
+    int total_chunks;
+    int chunk_size;
+    char data[CHUNK_SIZE];
+} FrameChunk;
+
+// Token bucket capping a stream's burst and average bitrate
+typedef struct {
+    double rate;                // Bytes per second
+    double burst;               // Bucket depth in bytes
+    double tokens;
+    struct timespec last_refill;
+    double wait_seconds;        // Total time spent waiting for tokens
+} TokenBucket;
+
+// Absolute-schedule pacer for one outgoing stream (see pacing.c)
+typedef struct {
+    const char* name;
+    long period_ns;             // 0 = unscheduled (live mode)
+    TokenBucket bucket;
+    long frames;
+    long late_frames;           // Sent more than PACE_LATE_THRESHOLD_MS late
+    double late_total;
+    double late_max;
+    double late_last;           // Lateness of the previous frame
+    double jitter;              // Smoothed change in lateness frame to frame
+} StreamPacer;
+
+// A thread that acts on frame clock ticks instead of polling (see pacing.c)
+typedef struct {
+    const char* name;
+    int frame;                  // Last frame picked up
+    long ticks;
+    long skipped;               // Frames published while it was busy
+    double lag_total;           // Tick to pickup, seconds
+    double lag_max;
+} TickFollower;
+
+typedef struct {
+    long frames;
+    long chunks;
+    long syscalls;
+    long datagrams;             // Chunks times destinations, resends included
+    long offloaded;             // Of those, sent inside a UDP_SEGMENT run
+    long send_failures;         // Sends one destination refused (the rest went on)
+    long wire_bytes;            // UDP payload bytes, headers included
+    double send_seconds;        // Summed first-submit to last-return time
+    double max_send_seconds;
+} ChunkSendStats;
+
+// Copy of a recently sent frame, kept to answer NACKs for its chunks
+typedef struct {
+    unsigned char* data;        // WIRE_MAX_FRAME_BYTES
+    uint32_t length;
+    int frame_num;              // 0 = empty
+    uint16_t chunk_size;
+    uint16_t fec_group;
+    struct timespec sent_at;
+} SentFrame;
+
+typedef struct {
+    SentFrame frames[REPAIR_HISTORY_FRAMES];
+    long nacks;
+    long nacks_expired;         // Frame past WIRE_REPAIR_DEADLINE_MS or no longer held
+    long nacks_refused;         // From an address that is not subscribed
+    long chunks_refused;        // Over REPAIR_MAX_RESENDS for the requester and frame
+    long chunks_resent;
+} RepairHistory;
+
+// One destination of the stream
+typedef struct {
+    struct sockaddr_in addr;
+    uint64_t expires_ns;        // Lease end (wire_now_ns), 0 = fixed target
+    // Chunks resent to it, per repair history slot (frame n in n % REPAIR_HISTORY_FRAMES)
+    int resend_frame[REPAIR_HISTORY_FRAMES];
+    int resent[REPAIR_HISTORY_FRAMES];
+    int send_failures;          // Sends to it refused in a row (no route, firewall...)
+} Subscriber;
+
 typedef struct {
-    int frame_id;
-    char frame_path[256];
-    int frame_width;
-    int frame_height;
+    Subscriber entries[MAX_SUBSCRIBERS];
+    int count;
+    long joined;
+    long left;
+    long expired;
+    long evicted;               // Dropped after SUBSCRIBER_MAX_SEND_FAILURES
+    uint64_t cookie_key[2];     // Keys the SUBSCRIBE cookies, drawn at start-up
+    long challenged;            // SUBSCRIBEs answered with a COOKIE instead
+} SubscriberRegistry;
+
+// Byte budget of the stream, set from receiver REPORTs, and the encoding
+// level that fits it (see rate_control.c)
+typedef struct {
+    double budget;              // Bytes per second the worst receiver gets through
+    double max_budget;
+    int level;                  // Ladder step in use, 0 = best
+    double frame_bytes[ADAPT_LEVELS];   // Average encoded frame per level, 0 = not seen yet
+    uint64_t last_cut_ns;       // wire_now_ns of the last budget cut
+    uint64_t last_growth_ns;
+    double window_loss;         // Worst loss reported since the last growth check
+    long reports;
+    long reports_refused;       // From an address that is not subscribed
+    long cuts;
+    long level_changes;
+} RateController;
+
+// One feed's outgoing message stream: META, ALERT and CHUNK messages from
+// one socket (shared by the streams of all feeds), each encoded once and
+// sent to every subscriber of the feed (see chunk_sender.c)
+typedef struct {
+    int sock;
+    uint8_t source_id;          // Feed this stream carries, 0 = primary
+    SubscriberRegistry subscribers;
+    uint32_t sequence;          // Of the next message
+    uint16_t chunk_size;        // Chunk payload bytes
+    uint16_t fec_group;         // Data chunks per parity chunk, 0 = no FEC
+    bool segment_offload;       // Runs of chunks go out as one UDP_SEGMENT send
+    TokenBucket* bucket;
+    ChunkSendStats stats;       // Every message, chunks and resends included
+    RepairHistory repairs;
+    RateController rate;        // Fed by REPORTs
+    long meta_sent;
+    long alerts_sent;
+} StreamSender;
+
+// Read-only mapping of an archive
+typedef struct {
+    void* base;
+    size_t size;
+    const FrameArchiveHeader* header;
+    const FrameIndexEntry* index;
+} FrameArchive;
+
+// One encoded frame in the live ingest ring
+typedef struct {
+    int frame_number;       // 0 = never written
+    uint32_t length;
     SensorData sensor;
-} VideoPacket;
+    FrameTimes times;
+    unsigned char data[LIVE_SLOT_BYTES];
+} FrameRingSlot;
+
+// Fixed-size ring of encoded frames in its own shared memory segment
+typedef struct {
+    int head;               // Newest published frame number
+    bool producer_done;
+    pthread_mutex_t mutex;
+    pthread_cond_t frame_published;
+    FrameRingSlot slots[LIVE_RING_SLOTS];
+} FrameRing;
+
+// The newest LIVE_RAW_SLOTS frames of a feed as captured (BGR), so the
+// stream encoder in this process starts from the camera's pixels rather
+// than from the ring's JPEG
+typedef struct {
+    pthread_mutex_t mutex;
+    int frame_number[LIVE_RAW_SLOTS];   // 0 = empty
+    unsigned char* pixels;              // Frame n at slot n % LIVE_RAW_SLOTS
+} LiveRawFrames;
+
+// One camera feed. Its ring carries both the frames and the sensor record
+// captured with each one, so every feed has its own timeline, its own
+// frame cache and its own stream (WireHeader.source_id = id).
+typedef struct {
+    int id;                         // 0 = primary feed (drives the frame clock)
+    int kind;                       // LIVE_SOURCE_VIDEO or LIVE_SOURCE_SYNTHETIC
+    char path[256];                 // Video file for LIVE_SOURCE_VIDEO
+    FrameRing* ring;
+    LiveRawFrames* raw;             // NULL when no encoder reads the feed
+    struct FrameCache* cache;       // The feed's frames for the sender and dashboard
+    int frames_published;
+    int last_streamed;              // Newest frame its stream sent
+    int detections;
+    DetectionResult detection;      // Latest, under shm->detection_mutex
+} VideoSource;
 
 // Shared memory structure - UPDATED ARRAY SIZE
 typedef struct {
     // System control
     bool system_active;
     bool frames_extracted;
+    bool live_mode;                 // Frames come from the live ring, not the archive
     
     // Frame tracking
     int current_frame;
@@ -94,14 +387,57 @@ typedef struct {
     pthread_cond_t ui_update_cond;
     sem_t* sem_frame_ready;
     sem_t* sem_processing_done;
+    
+    // Frame clock: broadcast (under frame_mutex) as each frame is published
+    pthread_cond_t frame_tick_cond;
+    uint64_t frame_tick_ns;         // CLOCK_MONOTONIC time of the last tick
 } SharedMemory;
 
+// One cached encoded frame; data points into the cache arena
+typedef struct {
+    int frame_number;       // 0 = empty
+    uint32_t length;
+    int refcount;           // Consumers currently borrowing the bytes
+    SensorData sensor;
+    FrameTimes times;
+    unsigned char* data;
+} FrameCacheEntry;
+
+// Process-wide cache of one feed's encoded frames
+typedef struct FrameCache {
+    unsigned char* arena;           // FRAME_CACHE_SLOTS * FRAME_CACHE_SLOT_BYTES, allocated once
+    FrameCacheEntry entries[FRAME_CACHE_SLOTS];
+    int cursor;                     // Furthest frame any consumer has asked for
+    int newest;                     // Newest frame loaded
+    bool source_done;
+    bool stop;
+    SharedMemory* shm;
+    FrameRing* ring;                // Live source, or NULL for the archive
+    FrameArchive archive;
+    int rendition;
+    pthread_t prefetcher;
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;         // Frame loaded or reference released
+} FrameCache;
+
 // System state structure
 typedef struct {
     SharedMemory* shm;
     int udp_socket;
+    struct sockaddr_in targets[MAX_STREAM_TARGETS];  // --client / --multicast
+    int target_count;
+    FrameRing* ring;                // Primary feed's ring, NULL unless running with --live
+    FrameCache* cache;              // Primary feed's frames (the archive's without --live)
+    VideoSource sources[MAX_SOURCES];
+    int source_count;
 } SystemState;
 
+// Capture worker pool shared by all live sources (opaque, C++ implemented)
+typedef struct CapturePool CapturePool;
+
+// Re-encodes stream frames on the quality ladder (opaque, C++ implemented)
+typedef struct AdaptiveEncoder AdaptiveEncoder;
+
 // C++ compatibility wrapper
 #ifdef __cplusplus
 extern "C" {
@@ -111,24 +447,138 @@ extern "C" {
 SharedMemory* init_shared_memory();
 void cleanup_shared_memory(SharedMemory* shm);
 void initialize_sensor_data(SharedMemory* shm);
+void generate_sensor_reading(int index, SensorData* sensor);
 
 // Thread functions
 void* sensor_data_thread(void* arg);
-void* video_acquisition_thread(void* arg);
 void* detection_thread(void* arg);
 void* processing_pipeline_thread(void* arg);
 void* watchdog_thread(void* arg);
 void* frame_sender_thread(void* arg);
-void* video_streamer_thread(void* arg);
 void* web_server_thread(void* arg);
 void* ui_terminal_thread(void* arg);
 
 // Video extraction function (C++ implemented)
 bool extract_frames_from_video(SharedMemory* shm);
 
+// Live capture pool: workers <= 0 uses CAPTURE_POOL_WORKERS / the core count.
+// Unpaced pools decode as fast as they can (benchmarking only).
+CapturePool* capture_pool_start(SystemState* state, int workers, bool paced);
+int capture_pool_workers(const CapturePool* pool);
+void capture_pool_stop(CapturePool* pool);
+void capture_pool_join(CapturePool* pool);
+void benchmark_multi_source(SharedMemory* shm, int kind, int workers);
+
+// Stream frames re-encoded on the quality ladder, whole or as tile deltas (C++ implemented)
+AdaptiveEncoder* adaptive_encoder_create(int width, int height, bool tiles);
+void adaptive_encoder_destroy(AdaptiveEncoder* encoder);
+void adaptive_encoder_raw(AdaptiveEncoder* encoder, int frame_number,
+                          const unsigned char* pixels, int width, int height);
+const unsigned char* adaptive_encoder_frame(AdaptiveEncoder* encoder, int frame_number,
+                                            const unsigned char* source, uint32_t source_length,
+                                            int* level, uint32_t* length,
+                                            int* width, int* height);
+void adaptive_encoder_force_key(AdaptiveEncoder* encoder);
+void print_adaptive_stats(const char* label, const AdaptiveEncoder* encoder);
+void benchmark_tile_delta();
+
+// Frame archive (single mmap'ed file replacing per-frame files)
+bool frame_archive_write(const char* path, int frame_count,
+                         const unsigned char* const* frames, const uint32_t* lengths,
+                         const SensorData* sensors);
+bool frame_archive_open(FrameArchive* archive, const char* path);
+const unsigned char* frame_archive_frame(const FrameArchive* archive, int frame_number,
+                                         uint32_t* length);
+const unsigned char* frame_archive_rendition(const FrameArchive* archive, int frame_number,
+                                             int rendition, uint32_t* length);
+int frame_archive_pick_rendition(const FrameArchive* archive, int max_width);
+const SensorData* frame_archive_sensor(const FrameArchive* archive, int frame_number);
+void frame_archive_close(FrameArchive* archive);
+
+// Live ingest ring
+FrameRing* init_frame_ring(int source_id);
+void cleanup_frame_ring(FrameRing* ring, int source_id);
+bool frame_ring_publish(FrameRing* ring, int frame_number, const unsigned char* data,
+                        uint32_t length, const SensorData* sensor, const FrameTimes* times);
+void frame_ring_close(FrameRing* ring);
+bool frame_ring_read(FrameRing* ring, SharedMemory* shm, int* frame_number,
+                     unsigned char* buf, uint32_t* length, SensorData* sensor,
+                     FrameTimes* times);
+LiveRawFrames* live_raw_create(void);
+void live_raw_destroy(LiveRawFrames* raw);
+void live_raw_put(LiveRawFrames* raw, int frame_number, const unsigned char* pixels);
+bool live_raw_get(LiveRawFrames* raw, int frame_number, unsigned char* pixels);
+
+// Frame cache
+FrameCache* frame_cache_create(SharedMemory* shm, FrameRing* ring);
+void frame_cache_destroy(FrameCache* cache);
+const FrameCacheEntry* frame_cache_borrow(FrameCache* cache, int* frame_number);
+const FrameCacheEntry* frame_cache_try_borrow(FrameCache* cache, int frame_number);
+int frame_cache_newest(FrameCache* cache);
+void frame_cache_release(FrameCache* cache, const FrameCacheEntry* entry);
+
+// Outgoing message stream (see chunk_sender.c)
+uint16_t chunk_payload_size(const struct sockaddr_in* dest);
+bool stream_sender_init(StreamSender* sender, int sock, uint16_t chunk_size,
+                        uint16_t fec_group, TokenBucket* bucket);
+bool stream_sender_enable_offload(StreamSender* sender);
+void stream_sender_free(StreamSender* sender);
+bool stream_send_meta(StreamSender* sender, int frame_num, const SensorData* sensor,
+                      const FrameTimes* times, int width, int height);
+bool stream_send_alert(StreamSender* sender, const DetectionResult* detection);
+int send_frame_chunks(StreamSender* sender, int frame_num, const unsigned char* jpeg,
+                      uint32_t length);
+int serve_stream_requests(StreamSender* senders, int sender_count, long long timeout_ns);
+void print_chunk_send_stats(const char* label, const ChunkSendStats* stats);
+bool repair_history_init(RepairHistory* history);
+void repair_history_free(RepairHistory* history);
+void repair_history_store(RepairHistory* history, int frame_num, const unsigned char* jpeg,
+                          uint32_t length, uint16_t chunk_size, uint16_t fec_group);
+void print_repair_stats(const char* label, const RepairHistory* history);
+void benchmark_chunk_send();
+void benchmark_fec();
+void benchmark_fanout();
+void benchmark_segmentation();
+
+// Stream subscribers (see subscribers.c)
+void subscriber_registry_init(SubscriberRegistry* registry);
+int subscriber_join(SubscriberRegistry* registry, const struct sockaddr_in* addr,
+                    uint64_t expires_ns);
+bool subscriber_leave(SubscriberRegistry* registry, const struct sockaddr_in* addr);
+Subscriber* subscriber_lookup(SubscriberRegistry* registry, const struct sockaddr_in* addr);
+Subscriber* subscriber_group_for(SubscriberRegistry* registry, const struct sockaddr_in* from);
+uint64_t subscriber_cookie(const SubscriberRegistry* registry, const struct sockaddr_in* addr,
+                           uint64_t now_ns);
+bool subscriber_cookie_valid(const SubscriberRegistry* registry, const struct sockaddr_in* addr,
+                             uint64_t cookie, uint64_t now_ns);
+int subscriber_expire(SubscriberRegistry* registry, uint64_t now_ns);
+bool parse_stream_target(const char* text, int default_port, struct sockaddr_in* addr);
+void print_subscriber_stats(const char* label, const SubscriberRegistry* registry);
+
+// Bitrate adaptation (see rate_control.c)
+void rate_controller_init(RateController* rate, double max_budget);
+void rate_controller_report(RateController* rate, const WireReport* report,
+                            const struct sockaddr_in* from, uint64_t now_ns);
+int rate_controller_level(RateController* rate, int fps, uint64_t now_ns);
+void rate_controller_frame_sent(RateController* rate, int level, uint32_t length);
+void print_rate_stats(const char* label, const RateController* rate);
+
+// Stream pacing (see pacing.c)
+void token_bucket_init(TokenBucket* bucket, double bytes_per_second, double burst_bytes);
+void token_bucket_consume(TokenBucket* bucket, size_t bytes);
+void pacer_init(StreamPacer* pacer, const char* name, int fps,
+                double bytes_per_second, double burst_bytes);
+void pacer_wait_frame(StreamPacer* pacer, int frame_number);
+long long pacer_ns_until_frame(const StreamPacer* pacer, int frame_number);
+void pacer_frame_sent(StreamPacer* pacer, int frame_number);
+void pacer_report(const StreamPacer* pacer);
+void frame_clock_tick(SharedMemory* shm);
+void tick_follower_init(TickFollower* follower, const char* name);
+int frame_clock_wait(SharedMemory* shm, TickFollower* follower, int timeout_ms);
+void tick_follower_report(const TickFollower* follower);
+
 // UDP communication functions
 int init_udp_socket();
-void send_video_packet_udp(int socket_fd, VideoPacket* packet);
 
 // Signal handling
 void init_signal_handlers(SharedMemory* shm);
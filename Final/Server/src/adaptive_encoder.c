@@ -0,0 +1,358 @@
+#include "../include/aviation_system.h"
+#include <opencv2/opencv.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+using namespace cv;
+
+// Stream frames at the level the rate controller picks. Each source frame is
+// decoded once into a raw store of the last ADAPT_CACHE_FRAMES frames (or
+// handed over raw by adaptive_encoder_raw(), skipping the decode), and
+// every level of the ADAPT_QUALITIES / ADAPT_SCALES ladder is encoded from
+// that raw image, never from another level. Encodes are kept next to the
+// raw frame, so a frame is encoded at most once per level however often it
+// is asked for. A frame that comes out over WIRE_MAX_FRAME_BYTES goes out
+// one level lower instead of being dropped.
+//
+// With tile delta coding the stream carries TILES frames (wire_protocol.h):
+// a keyframe every TILE_KEYFRAME_INTERVAL frames, and in between only the
+// TILE_SIZE tiles that differ from the keyframe by more than
+// TILE_CHANGE_THRESHOLD, packed into one JPEG atlas. Tiles are compared
+// with the keyframe's raw pixels, not the previous frame, so the drift a
+// receiver sees stays under the threshold however long the scene is still.
+// A level change, or more than TILE_KEYFRAME_SHARE of the tiles changed,
+// brings the next keyframe forward.
+//
+// Only the frame sender thread uses an encoder, so there is no lock.
+
+static const int level_qualities[ADAPT_LEVELS] = ADAPT_QUALITIES;
+static const int level_scales[ADAPT_LEVELS] = ADAPT_SCALES;
+
+typedef struct {
+    std::vector<uchar> jpeg;
+    int width;
+    int height;
+    bool encoded;
+} LevelEncode;
+
+typedef struct {
+    int frame_number;               // 0 = empty
+    Mat raw;
+    LevelEncode levels[ADAPT_LEVELS];
+} RawFrame;
+
+// What the receivers hold: the last keyframe, at its level's size
+typedef struct {
+    Mat key;                        // Empty until the first keyframe
+    uint32_t key_frame;
+    int key_level;
+    int since_key;                  // Deltas sent over this keyframe
+    bool force_key;                 // Some receiver may lack the keyframe
+    std::vector<uchar> out;         // Last TILES frame built
+    long keys;
+    long deltas;
+    long tiles_sent;
+} TileCoder;
+
+struct AdaptiveEncoder {
+    int width;                      // Level size at 100%
+    int height;
+    bool tiles;                     // Send TILES frames rather than whole JPEGs
+    RawFrame frames[ADAPT_CACHE_FRAMES];   // Frame n in slot n % ADAPT_CACHE_FRAMES
+    TileCoder tile;
+    long decodes;
+    long raw_frames;                // Handed over raw, not decoded
+    long encodes;
+    long reuses;
+    long stepped_down;
+    double encode_seconds;
+    long long level_frames[ADAPT_LEVELS];
+    long long level_bytes[ADAPT_LEVELS];
+};
+
+static double seconds_since(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+AdaptiveEncoder* adaptive_encoder_create(int width, int height, bool tiles) {
+    AdaptiveEncoder* encoder = new AdaptiveEncoder();
+    encoder->width = width;
+    encoder->height = height;
+    encoder->tiles = tiles;
+    return encoder;
+}
+
+void adaptive_encoder_destroy(AdaptiveEncoder* encoder) {
+    delete encoder;
+}
+
+static RawFrame* empty_slot(AdaptiveEncoder* encoder, int frame_number) {
+    RawFrame* slot = &encoder->frames[frame_number % ADAPT_CACHE_FRAMES];
+    slot->frame_number = 0;
+    for (int l = 0; l < ADAPT_LEVELS; l++) slot->levels[l].encoded = false;
+    return slot;
+}
+
+// Frame frame_number's raw BGR pixels (width x height, rows packed), so it
+// is encoded from them rather than from a decoded JPEG
+void adaptive_encoder_raw(AdaptiveEncoder* encoder, int frame_number,
+                          const unsigned char* pixels, int width, int height) {
+    RawFrame* slot = empty_slot(encoder, frame_number);
+    Mat(height, width, CV_8UC3, (void*)pixels).copyTo(slot->raw);
+    slot->frame_number = frame_number;
+    encoder->raw_frames++;
+}
+
+// The raw image of frame_number, decoding source into its slot if needed
+static RawFrame* raw_frame(AdaptiveEncoder* encoder, int frame_number,
+                           const unsigned char* source, uint32_t length) {
+    RawFrame* slot = &encoder->frames[frame_number % ADAPT_CACHE_FRAMES];
+    if (slot->frame_number == frame_number) return slot;
+
+    slot = empty_slot(encoder, frame_number);
+    Mat bytes(1, (int)length, CV_8UC1, (void*)source);
+    slot->raw = imdecode(bytes, IMREAD_COLOR);
+    if (slot->raw.empty()) return NULL;
+    slot->frame_number = frame_number;
+    encoder->decodes++;
+    return slot;
+}
+
+// The raw frame at a level's size
+static void level_image(const AdaptiveEncoder* encoder, const RawFrame* frame, int level,
+                        Mat& image) {
+    Size size(encoder->width * level_scales[level] / 100,
+              encoder->height * level_scales[level] / 100);
+    if (frame->raw.size().width == size.width && frame->raw.size().height == size.height) {
+        image = frame->raw;
+    } else {
+        resize(frame->raw, image, size, 0, 0, INTER_AREA);
+    }
+}
+
+static void encode_jpeg(AdaptiveEncoder* encoder, const Mat& image, int level,
+                        std::vector<uchar>& jpeg) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    std::vector<int> params;
+    params.push_back(IMWRITE_JPEG_QUALITY);
+    params.push_back(level_qualities[level]);
+    imencode(".jpg", image, jpeg, params);
+    encoder->encodes++;
+    encoder->encode_seconds += seconds_since(&start);
+}
+
+static const LevelEncode* encode_level(AdaptiveEncoder* encoder, RawFrame* frame, int level) {
+    LevelEncode* out = &frame->levels[level];
+    if (out->encoded) {
+        encoder->reuses++;
+        return out;
+    }
+
+    Mat image;
+    level_image(encoder, frame, level, image);
+    encode_jpeg(encoder, image, level, out->jpeg);
+    out->width = image.cols;
+    out->height = image.rows;
+    out->encoded = true;
+    return out;
+}
+
+// Where tile t of a columns-wide grid sits, cut to the image
+static Rect tile_rect(const Mat& image, int columns, int t) {
+    int x = (t % columns) * TILE_SIZE;
+    int y = (t / columns) * TILE_SIZE;
+    int width = image.cols - x < TILE_SIZE ? image.cols - x : TILE_SIZE;
+    int height = image.rows - y < TILE_SIZE ? image.rows - y : TILE_SIZE;
+    return Rect(x, y, width, height);
+}
+
+// Fills changed with the tiles of image that differ from the keyframe.
+// Returns false when so many did that a keyframe is the better deal.
+static bool tiles_changed(const Mat& key, const Mat& image, int columns, int rows,
+                          std::vector<int>& changed) {
+    int total = columns * rows;
+    for (int t = 0; t < total; t++) {
+        Rect rect = tile_rect(image, columns, t);
+        double difference = norm(image(rect), key(rect), NORM_L1) /
+                            ((double)rect.width * rect.height * 3);
+        if (difference > TILE_CHANGE_THRESHOLD) changed.push_back(t);
+    }
+    return changed.size() <= TILE_KEYFRAME_SHARE * total;
+}
+
+// The TILES frame for frame_number at level into coder->out
+static void tile_frame(AdaptiveEncoder* encoder, RawFrame* frame, int level) {
+    TileCoder* coder = &encoder->tile;
+    Mat image;
+    level_image(encoder, frame, level, image);
+
+    WireTiles header;
+    header.tile_size = TILE_SIZE;
+    header.columns = (uint8_t)((image.cols + TILE_SIZE - 1) / TILE_SIZE);
+    header.rows = (uint8_t)((image.rows + TILE_SIZE - 1) / TILE_SIZE);
+    std::vector<int> changed;
+    bool key = coder->key.empty() || coder->force_key || coder->key_level != level ||
+               coder->since_key + 1 >= TILE_KEYFRAME_INTERVAL ||
+               !tiles_changed(coder->key, image, header.columns, header.rows, changed);
+
+    uint8_t head[WIRE_TILES_HEADER_SIZE];
+    if (key) {
+        header.flags = WIRE_TILES_KEY;
+        header.reference = (uint32_t)frame->frame_number;
+        const LevelEncode* whole = encode_level(encoder, frame, level);
+        coder->out.assign(head, head + wire_tiles_encode(&header, head));
+        coder->out.insert(coder->out.end(), whole->jpeg.begin(), whole->jpeg.end());
+        coder->key = image.clone();
+        coder->key_frame = header.reference;
+        coder->key_level = level;
+        coder->since_key = 0;
+        coder->force_key = false;
+        coder->keys++;
+        return;
+    }
+
+    header.flags = 0;
+    header.reference = coder->key_frame;
+    coder->out.assign(head, head + wire_tiles_encode(&header, head));
+    size_t bitmap_at = coder->out.size();
+    coder->out.resize(bitmap_at + wire_tiles_bitmap_size(&header), 0);
+    for (size_t i = 0; i < changed.size(); i++) {
+        coder->out[bitmap_at + changed[i] / 8] |= (uint8_t)(1u << (changed[i] % 8));
+    }
+
+    if (!changed.empty()) {
+        int atlas_columns = (int)changed.size() < header.columns ? (int)changed.size()
+                                                                  : header.columns;
+        int atlas_rows = ((int)changed.size() + atlas_columns - 1) / atlas_columns;
+        Mat atlas(atlas_rows * TILE_SIZE, atlas_columns * TILE_SIZE, CV_8UC3, Scalar(0, 0, 0));
+        for (size_t i = 0; i < changed.size(); i++) {
+            Rect from = tile_rect(image, header.columns, changed[i]);
+            Rect to((int)(i % atlas_columns) * TILE_SIZE, (int)(i / atlas_columns) * TILE_SIZE,
+                    from.width, from.height);
+            image(from).copyTo(atlas(to));
+        }
+        std::vector<uchar> jpeg;
+        encode_jpeg(encoder, atlas, level, jpeg);
+        coder->out.insert(coder->out.end(), jpeg.begin(), jpeg.end());
+    }
+    coder->since_key++;
+    coder->deltas++;
+    coder->tiles_sent += (long)changed.size();
+}
+
+// The last keyframe is recorded as it is built, not as it arrives. When a
+// frame could not be sent, or a subscriber joined that never saw the
+// keyframe, the sender calls this so the next TILES frame is a keyframe.
+void adaptive_encoder_force_key(AdaptiveEncoder* encoder) {
+    encoder->tile.force_key = true;
+}
+
+// Frame frame_number (whose best available JPEG is source, unless its raw
+// pixels were handed over) encoded at *level, or lower if that does not fit
+// a stream frame; *level gets the level used. Returns NULL if source cannot
+// be decoded or no level fits.
+// Whole JPEGs stay valid until ADAPT_CACHE_FRAMES newer frames came
+// through, TILES frames until the next call.
+const unsigned char* adaptive_encoder_frame(AdaptiveEncoder* encoder, int frame_number,
+                                            const unsigned char* source, uint32_t source_length,
+                                            int* level, uint32_t* length,
+                                            int* width, int* height) {
+    RawFrame* frame = raw_frame(encoder, frame_number, source, source_length);
+    if (!frame) return NULL;
+
+    for (int l = *level; l < ADAPT_LEVELS; l++) {
+        const LevelEncode* whole = NULL;
+        const std::vector<uchar>* bytes;
+        if (encoder->tiles) {
+            tile_frame(encoder, frame, l);
+            bytes = &encoder->tile.out;
+        } else {
+            whole = encode_level(encoder, frame, l);
+            bytes = &whole->jpeg;
+        }
+        if (bytes->size() > WIRE_MAX_FRAME_BYTES) continue;
+        if (l != *level) encoder->stepped_down++;
+        *level = l;
+        *length = (uint32_t)bytes->size();
+        *width = encoder->width * level_scales[l] / 100;
+        *height = encoder->height * level_scales[l] / 100;
+        encoder->level_frames[l]++;
+        encoder->level_bytes[l] += bytes->size();
+        return bytes->data();
+    }
+    return NULL;
+}
+
+void print_adaptive_stats(const char* label, const AdaptiveEncoder* encoder) {
+    printf("%s Adaptive quality: %ld frames decoded, %ld raw | "
+           "%ld encodes (%.2f ms avg) | %ld reused | %ld stepped down to fit\n",
+           label, encoder->decodes, encoder->raw_frames, encoder->encodes,
+           encoder->encodes ? encoder->encode_seconds * 1000.0 / encoder->encodes : 0.0,
+           encoder->reuses, encoder->stepped_down);
+    for (int l = 0; l < ADAPT_LEVELS; l++) {
+        if (encoder->level_frames[l] == 0) continue;
+        printf("%s   level %d (quality %d, %dx%d): %lld frames, %.1f KB/frame\n",
+               label, l, level_qualities[l], encoder->width * level_scales[l] / 100,
+               encoder->height * level_scales[l] / 100, encoder->level_frames[l],
+               encoder->level_bytes[l] / 1024.0 / encoder->level_frames[l]);
+    }
+    const TileCoder* coder = &encoder->tile;
+    if (coder->deltas > 0) {
+        printf("%s Tiles: %ld keyframes, %ld deltas averaging %.1f changed tiles\n",
+               label, coder->keys, coder->deltas, (double)coder->tiles_sent / coder->deltas);
+    }
+}
+
+// --bench-tiles: bytes per frame of whole JPEGs against tile deltas at
+// every level of the ladder, over the archived clip
+void benchmark_tile_delta() {
+    FrameArchive archive;
+    if (!frame_archive_open(&archive, FRAME_ARCHIVE_PATH)) {
+        printf("[Benchmark] Error: Cannot map %s (run once to extract the clip)\n",
+               FRAME_ARCHIVE_PATH);
+        return;
+    }
+    int frames = (int)archive.header->frame_count;
+    int source_rendition = (int)archive.header->rendition_count - 1;
+    printf("\n[Benchmark] Tile deltas: %d frames of the archived clip, %d px tiles, keyframe "
+           "every %d frames\n", frames, TILE_SIZE, TILE_KEYFRAME_INTERVAL);
+    printf("[Benchmark] %-28s %12s %12s %8s %10s %8s\n", "level", "whole KB/fr", "tiles KB/fr",
+           "saved", "keyframes", "tiles/fr");
+
+    for (int level = 0; level < ADAPT_LEVELS; level++) {
+        AdaptiveEncoder* whole = adaptive_encoder_create(FRAME_WIDTH, FRAME_HEIGHT, false);
+        AdaptiveEncoder* tiles = adaptive_encoder_create(FRAME_WIDTH, FRAME_HEIGHT, true);
+        AdaptiveEncoder* encoders[2] = {whole, tiles};
+        for (int frame = 1; frame <= frames; frame++) {
+            uint32_t length;
+            const unsigned char* jpeg = frame_archive_rendition(&archive, frame, source_rendition,
+                                                                &length);
+            if (!jpeg) continue;
+            for (int e = 0; e < 2; e++) {
+                int used = level;
+                int width, height;
+                uint32_t bytes;
+                adaptive_encoder_frame(encoders[e], frame, jpeg, length, &used, &bytes,
+                                       &width, &height);
+            }
+        }
+
+        double whole_kb = whole->level_frames[level] ?
+                          whole->level_bytes[level] / 1024.0 / whole->level_frames[level] : 0;
+        double tiles_kb = tiles->level_frames[level] ?
+                          tiles->level_bytes[level] / 1024.0 / tiles->level_frames[level] : 0;
+        char name[40];
+        snprintf(name, sizeof(name), "%d (quality %d, %dx%d)", level, level_qualities[level],
+                 FRAME_WIDTH * level_scales[level] / 100, FRAME_HEIGHT * level_scales[level] / 100);
+        printf("[Benchmark] %-28s %12.2f %12.2f %7.0f%% %10ld %8.1f\n", name, whole_kb, tiles_kb,
+               whole_kb > 0 ? 100.0 * (1.0 - tiles_kb / whole_kb) : 0.0, tiles->tile.keys,
+               tiles->tile.deltas ? (double)tiles->tile.tiles_sent / tiles->tile.deltas : 0.0);
+        adaptive_encoder_destroy(whole);
+        adaptive_encoder_destroy(tiles);
+    }
+    printf("[Benchmark] (tiles/fr: changed tiles per delta frame; the live sender uses "
+           "TILE_DELTA %d)\n", TILE_DELTA);
+    frame_archive_close(&archive);
+}
@@ -0,0 +1,1190 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE             // sendmmsg()
+#endif
+#include "../include/aviation_system.h"
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/udp.h>
+#include <poll.h>
+#include <errno.h>
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103                 // linux/udp.h, kernel 4.18+
+#endif
+
+// The outgoing stream (see wire_protocol.h): per frame a META message with
+// its sensor record, an ALERT when a new obstacle was detected, then the
+// frame's CHUNK messages, all from one socket to every subscriber
+// (subscribers.c). Each message is encoded once; a sendmmsg() batch then
+// holds one datagram per message and subscriber, all pointing at the same
+// encoded header and, for chunks, straight into the frame bytes. So a
+// frame costs a handful of syscalls whatever the audience, instead of one
+// sendto() per chunk per client. Only the used bytes go on the wire (the
+// last chunk is short, never padded), and the chunk payload is sized to
+// fill one datagram on the path MTU. Optional XOR parity chunks let a
+// client rebuild one lost chunk per group (chunk_reassembly.c). Pacing
+// comes from the stream's token bucket (pacing.c), charged once per
+// message: it spaces the stream as each subscriber's path sees it. Chunks
+// neither arrived nor rebuilt are NACKed by the client and resent, to it
+// alone, from a copy of the last REPAIR_HISTORY_FRAMES frames.
+
+// Largest message whose header is built inside a batch
+#define BATCH_HEADER_BYTES WIRE_ALERT_SIZE
+
+static double seconds_between(const struct timespec* start, const struct timespec* end) {
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Payload bytes per chunk towards dest: CHUNK_PAYLOAD_SIZE if set, else
+// the largest that fits the path MTU the kernel reports for a connected
+// socket (CHUNK_PATH_MTU if it cannot be probed or dest is NULL)
+uint16_t chunk_payload_size(const struct sockaddr_in* dest) {
+    if (CHUNK_PAYLOAD_SIZE > 0) return (uint16_t)CHUNK_PAYLOAD_SIZE;
+
+    int mtu = CHUNK_PATH_MTU;
+    int probe = dest ? socket(AF_INET, SOCK_DGRAM, 0) : -1;
+    if (probe >= 0) {
+        int value = 0;
+        socklen_t value_len = sizeof(value);
+        if (connect(probe, (const struct sockaddr*)dest, sizeof(*dest)) == 0 &&
+            getsockopt(probe, IPPROTO_IP, IP_MTU, &value, &value_len) == 0 && value > 0) {
+            mtu = value;
+        }
+        close(probe);
+    }
+    return wire_chunk_payload_for_mtu(mtu);
+}
+
+// Sends from sock to the subscribers added later. chunk_size and fec_group
+// apply to every frame; the bucket (shared with a pacer or not) spaces all
+// messages of the stream.
+bool stream_sender_init(StreamSender* sender, int sock, uint16_t chunk_size,
+                        uint16_t fec_group, TokenBucket* bucket) {
+    memset(sender, 0, sizeof(*sender));
+    sender->sock = sock;
+    subscriber_registry_init(&sender->subscribers);
+    sender->sequence = 1;
+    sender->chunk_size = chunk_size;
+    sender->fec_group = fec_group;
+    sender->bucket = bucket;
+    // Receivers' REPORTs can only lower the budget from the stream's own cap
+    rate_controller_init(&sender->rate,
+                         bucket && bucket->rate > 0 ? bucket->rate : STREAM_SEND_RATE);
+    return repair_history_init(&sender->repairs);
+}
+
+// Sends runs of chunks as single UDP_SEGMENT buffers from now on, if the
+// kernel knows the option. Returns whether it does; a kernel that knows it
+// but cannot use it on the route is caught on the first send instead.
+bool stream_sender_enable_offload(StreamSender* sender) {
+    int size = 0;
+    socklen_t size_len = sizeof(size);
+    sender->segment_offload =
+        getsockopt(sender->sock, SOL_UDP, UDP_SEGMENT, &size, &size_len) == 0;
+    return sender->segment_offload;
+}
+
+void stream_sender_free(StreamSender* sender) {
+    repair_history_free(&sender->repairs);
+}
+
+static void stream_header(StreamSender* sender, WireHeader* header, uint32_t frame_id,
+                          uint64_t timestamp_ns) {
+    header->frame_id = frame_id;
+    header->sequence = sender->sequence++;
+    header->timestamp_ns = timestamp_ns;
+    header->source_id = sender->source_id;
+}
+
+// Messages queued for sendmmsg(): up to CHUNK_BATCH distinct messages, each
+// addressed to every destination. With segmentation offload, a run of
+// equal-sized messages (the last may be shorter) goes to each destination
+// as one UDP_SEGMENT send that the kernel splits into datagrams; the run's
+// iovecs are adjacent in iov[], so it needs no copy either.
+typedef struct {
+    StreamSender* sender;
+    Subscriber* dests;
+    int dest_count;
+    bool resend;                // Chunks answer a NACK (to its sender only)
+    uint8_t headers[CHUNK_BATCH][BATCH_HEADER_BYTES];
+    struct iovec iov[CHUNK_BATCH][2];
+    size_t slot_length[CHUNK_BATCH];
+    // UDP_SEGMENT size of the run starting at a slot (size_t keeps cmsghdr aligned)
+    size_t control[CHUNK_BATCH][CMSG_SPACE(sizeof(uint16_t)) / sizeof(size_t)];
+    int slots;                  // Distinct messages queued
+    size_t slot_bytes;          // One copy of each, as charged to the bucket
+    struct mmsghdr messages[SEND_BATCH_MESSAGES];
+    int message_slot[SEND_BATCH_MESSAGES];      // First slot and destination of each send
+    int message_dest[SEND_BATCH_MESSAGES];
+    int count;                  // Sends queued
+    size_t bytes;
+    long pending;               // Datagrams those sends become
+    long pending_offloaded;
+    bool offload_refused;       // The kernel rejected a UDP_SEGMENT send...
+    int refused_slot;           // ...the first slot of that run,
+    int refused_end;            // the slot after it,
+    int refused_dest;           // and its destination (earlier ones went out)
+    int syscalls;
+    long datagrams;
+    long offloaded;
+    size_t wire_bytes;
+    long failures;              // Sends one destination refused
+} SendBatch;
+
+static void send_batch_init(SendBatch* batch, StreamSender* sender, Subscriber* dests,
+                            int dest_count) {
+    batch->sender = sender;
+    batch->dests = dests;
+    batch->dest_count = dest_count;
+    batch->resend = false;
+    batch->slots = 0;
+    batch->slot_bytes = 0;
+    batch->count = 0;
+    batch->bytes = 0;
+    batch->pending = 0;
+    batch->pending_offloaded = 0;
+    batch->offload_refused = false;
+    batch->syscalls = 0;
+    batch->datagrams = 0;
+    batch->offloaded = 0;
+    batch->wire_bytes = 0;
+    batch->failures = 0;
+}
+
+// Errors about one destination (no route to it, a firewall or broadcast
+// rule, a smaller path MTU) rather than the socket: the batch goes on to
+// everyone else
+static bool send_error_is_per_destination(int error) {
+    return error == ENETUNREACH || error == EHOSTUNREACH || error == ENETDOWN ||
+           error == EPERM || error == EACCES || error == EADDRNOTAVAIL ||
+           error == ECONNREFUSED || error == EMSGSIZE;
+}
+
+// Takes the refused send `i` out of the batch's counts and charges it to
+// its destination; subscriber_expire() drops a destination that keeps
+// failing
+static void send_batch_skip(SendBatch* batch, int i) {
+    const struct msghdr* hdr = &batch->messages[i].msg_hdr;
+    long datagrams = (long)hdr->msg_iovlen / 2;
+    for (size_t v = 0; v < hdr->msg_iovlen; v++) batch->bytes -= hdr->msg_iov[v].iov_len;
+    batch->pending -= datagrams;
+    if (datagrams > 1) batch->pending_offloaded -= datagrams;
+    batch->dests[batch->message_dest[i]].send_failures++;
+    batch->failures++;
+}
+
+// Submits the queued sends. A send that only its destination refuses is
+// skipped; returns false on an error of the socket itself.
+static bool send_batch_submit(SendBatch* batch) {
+    // sendmmsg() may stop early; resubmit the remainder. It fails outright
+    // only when the first send it tries is refused.
+    int done = 0;
+    while (done < batch->count) {
+        int sent = sendmmsg(batch->sender->sock, batch->messages + done, batch->count - done, 0);
+        batch->syscalls++;
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && send_error_is_per_destination(errno)) {
+            send_batch_skip(batch, done++);
+            continue;
+        }
+        if (sent < 0) {
+            if (batch->sender->segment_offload &&
+                (errno == EIO || errno == EINVAL || errno == EOPNOTSUPP || errno == ENOPROTOOPT)) {
+                // Every send before the refused one went out
+                batch->offload_refused = true;
+                batch->refused_slot = batch->message_slot[done];
+                batch->refused_end = batch->refused_slot +
+                                     (int)batch->messages[done].msg_hdr.msg_iovlen / 2;
+                batch->refused_dest = batch->message_dest[done];
+            } else {
+                perror("[FrameSender] sendmmsg failed");
+            }
+            batch->count = 0;
+            batch->bytes = 0;
+            batch->pending = 0;
+            batch->pending_offloaded = 0;
+            return false;
+        }
+        for (int i = done; i < done + sent; i++) {
+            batch->dests[batch->message_dest[i]].send_failures = 0;
+        }
+        done += sent;
+    }
+    batch->datagrams += batch->pending;
+    batch->offloaded += batch->pending_offloaded;
+    batch->wire_bytes += batch->bytes;
+    batch->count = 0;
+    batch->bytes = 0;
+    batch->pending = 0;
+    batch->pending_offloaded = 0;
+    return true;
+}
+
+// Slots, from `first`, that can go out as one send: just the one without
+// offload, else every following slot of the same size plus at most one
+// shorter slot to end the run, within the kernel's limits
+static int send_batch_run(const SendBatch* batch, int first) {
+    if (!batch->sender->segment_offload) return 1;
+    size_t size = batch->slot_length[first];
+    int run = 1;
+    while (first + run < batch->slots && run < WIRE_MAX_SEGMENTS &&
+           (run + 1) * size <= WIRE_MAX_DATAGRAM) {
+        size_t next = batch->slot_length[first + run];
+        if (next > size) break;
+        run++;
+        if (next < size) break;
+    }
+    return run;
+}
+
+// Turns the queued slots from `first` into sends and submits them. Slots
+// before `resume_end` only go to destinations from `resume_dest` on (the
+// others already have them); later slots go to every destination.
+static bool send_batch_send_slots(SendBatch* batch, int first, int resume_end, int resume_dest) {
+    for (int slot = first; slot < batch->slots;) {
+        int run = send_batch_run(batch, slot);
+        size_t run_bytes = 0;
+        for (int i = slot; i < slot + run; i++) run_bytes += batch->slot_length[i];
+        if (run > 1) {
+            struct cmsghdr* cmsg = (struct cmsghdr*)batch->control[slot];
+            cmsg->cmsg_level = SOL_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            uint16_t segment = (uint16_t)batch->slot_length[slot];
+            memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+        }
+
+        for (int d = slot < resume_end ? resume_dest : 0; d < batch->dest_count; d++) {
+            // Audiences larger than one sendmmsg() go out in several
+            if (batch->count == SEND_BATCH_MESSAGES && !send_batch_submit(batch)) return false;
+            batch->message_slot[batch->count] = slot;
+            batch->message_dest[batch->count] = d;
+            struct mmsghdr* message = &batch->messages[batch->count++];
+            memset(message, 0, sizeof(*message));
+            message->msg_hdr.msg_name = (void*)&batch->dests[d].addr;
+            message->msg_hdr.msg_namelen = sizeof(batch->dests[d].addr);
+            message->msg_hdr.msg_iov = batch->iov[slot];
+            message->msg_hdr.msg_iovlen = 2 * run;
+            if (run > 1) {
+                message->msg_hdr.msg_control = batch->control[slot];
+                message->msg_hdr.msg_controllen = sizeof(batch->control[slot]);
+                batch->pending_offloaded += run;
+            }
+            batch->pending += run;
+            batch->bytes += run_bytes;
+        }
+        slot += run;
+    }
+    return send_batch_submit(batch);
+}
+
+// Waits for the batch's tokens, then sends it. Should the kernel refuse
+// UDP_SEGMENT, the stream falls back to one datagram per chunk for good and
+// the rest of the batch, from the refused send on, goes out that way.
+static bool send_batch_flush(SendBatch* batch) {
+    if (batch->slots == 0) return true;
+    token_bucket_consume(batch->sender->bucket, batch->slot_bytes);
+    bool ok = send_batch_send_slots(batch, 0, 0, 0);
+    if (!ok && batch->offload_refused) {
+        printf("[FrameSender] Warning: UDP_SEGMENT refused (%s), sending one datagram per chunk\n",
+               strerror(errno));
+        batch->sender->segment_offload = false;
+        batch->offload_refused = false;
+        ok = send_batch_send_slots(batch, batch->refused_slot, batch->refused_end,
+                                   batch->refused_dest);
+    }
+    batch->slots = 0;
+    batch->slot_bytes = 0;
+    return ok;
+}
+
+// Queues the message whose header_length bytes were just built in
+// headers[slots], followed by payload (may be NULL), for every destination.
+// The payload must stay valid until the batch is flushed.
+static bool send_batch_queue(SendBatch* batch, size_t header_length, const uint8_t* payload,
+                             size_t payload_length) {
+    int slot = batch->slots++;
+    batch->iov[slot][0].iov_base = batch->headers[slot];
+    batch->iov[slot][0].iov_len = header_length;
+    batch->iov[slot][1].iov_base = (void*)payload;
+    batch->iov[slot][1].iov_len = payload_length;
+    batch->slot_length[slot] = header_length + payload_length;
+    batch->slot_bytes += header_length + payload_length;
+    return batch->slots < CHUNK_BATCH || send_batch_flush(batch);
+}
+
+// Queues one chunk under the stream's next sequence number. Resent chunks
+// reach one receiver only; they carry sequence 0, or every other receiver
+// would count the numbers they take as lost.
+static bool send_batch_chunk(SendBatch* batch, WireChunkHeader* header, const uint8_t* payload) {
+    header->header.sequence = batch->resend ? 0 : batch->sender->sequence++;
+    wire_chunk_header_encode(header, batch->headers[batch->slots]);
+    return send_batch_queue(batch, WIRE_CHUNK_HEADER_SIZE, payload, header->payload_length);
+}
+
+static void stream_count_batch(StreamSender* sender, const SendBatch* batch) {
+    sender->stats.syscalls += batch->syscalls;
+    sender->stats.datagrams += batch->datagrams;
+    sender->stats.offloaded += batch->offloaded;
+    sender->stats.wire_bytes += (long)batch->wire_bytes;
+    sender->stats.send_failures += batch->failures;
+}
+
+static void wire_telemetry_from(const SensorData* sensor, WireTelemetry* out) {
+    out->flags = sensor->is_valid ? WIRE_TELEMETRY_VALID : 0;
+    out->sequence = (uint32_t)sensor->frame_number;
+    out->time_ns = sensor->time_ns;
+    out->latitude = sensor->latitude;
+    out->longitude = sensor->longitude;
+    out->altitude = sensor->altitude;
+    out->speed = sensor->speed;
+}
+
+// META for frame_num to every subscriber; goes out ahead of the frame's
+// chunks. times may be NULL if the capture and encode times are unknown.
+bool stream_send_meta(StreamSender* sender, int frame_num, const SensorData* sensor,
+                      const FrameTimes* times, int width, int height) {
+    if (sender->subscribers.count == 0) return true;
+
+    WireMeta meta;
+    memset(&meta, 0, sizeof(meta));
+    stream_header(sender, &meta.header, (uint32_t)frame_num, wire_realtime_ns());
+    meta.width = (uint16_t)width;
+    meta.height = (uint16_t)height;
+    wire_telemetry_from(sensor, &meta.telemetry);
+    if (times) {
+        meta.capture_ns = times->capture_ns;
+        meta.encode_ns = times->encode_ns;
+    }
+
+    static SendBatch batch;     // Only the sending thread gets here
+    send_batch_init(&batch, sender, sender->subscribers.entries, sender->subscribers.count);
+    size_t length = wire_meta_encode(&meta, batch.headers[0]);
+    bool ok = send_batch_queue(&batch, length, NULL, 0) && send_batch_flush(&batch);
+    stream_count_batch(sender, &batch);
+    if (ok) sender->meta_sent++;
+    return ok;
+}
+
+bool stream_send_alert(StreamSender* sender, const DetectionResult* detection) {
+    if (sender->subscribers.count == 0) return true;
+
+    WireAlert alert;
+    memset(&alert, 0, sizeof(alert));
+    stream_header(sender, &alert.header, (uint32_t)detection->frame_number, wire_realtime_ns());
+    wire_telemetry_from(&detection->sensor_snapshot, &alert.telemetry);
+    alert.confidence = detection->confidence;
+    snprintf(alert.type, sizeof(alert.type), "%s", detection->detection_type);
+
+    static SendBatch batch;     // Only the sending thread gets here
+    send_batch_init(&batch, sender, sender->subscribers.entries, sender->subscribers.count);
+    size_t length = wire_alert_encode(&alert, batch.headers[0]);
+    bool ok = send_batch_queue(&batch, length, NULL, 0) && send_batch_flush(&batch);
+    stream_count_batch(sender, &batch);
+    if (ok) sender->alerts_sent++;
+    return ok;
+}
+
+// Sends every chunk of one frame to every subscriber and keeps a copy for
+// NACKed resends. With fec_group > 0 each group of fec_group data chunks
+// is followed by its XOR parity chunk. Returns the number of distinct
+// chunks sent (0 with nobody subscribed), or -1 on a socket error or a
+// frame the wire format cannot carry.
+int send_frame_chunks(StreamSender* sender, int frame_num, const unsigned char* jpeg,
+                      uint32_t length) {
+    uint16_t chunk_size = sender->chunk_size;
+    uint16_t fec_group = sender->fec_group;
+    if (chunk_size == 0 || length == 0 || length > WIRE_MAX_FRAME_BYTES) return -1;
+    int total_chunks = wire_chunk_count(length, chunk_size);
+    if (total_chunks > WIRE_MAX_CHUNKS) return -1;
+    if (sender->subscribers.count == 0) return 0;
+
+    // Parity payloads, one per group, built before any of them is queued
+    int groups = wire_fec_groups((uint16_t)total_chunks, fec_group);
+    uint8_t* parity = NULL;
+    if (groups > 0) {
+        parity = (uint8_t*)calloc(groups, chunk_size);
+        if (!parity) return -1;
+        for (int i = 0; i < total_chunks; i++) {
+            wire_xor(parity + (size_t)(i / fec_group) * chunk_size,
+                     jpeg + (size_t)i * chunk_size, wire_chunk_length(length, chunk_size, i));
+        }
+    }
+
+    static SendBatch batch;     // Only the sending thread gets here
+    send_batch_init(&batch, sender, sender->subscribers.entries, sender->subscribers.count);
+
+    // One timestamp for all chunks of the frame: when the first was queued
+    WireChunkHeader header;
+    memset(&header, 0, sizeof(header));
+    header.header.frame_id = (uint32_t)frame_num;
+    header.header.timestamp_ns = wire_realtime_ns();
+    header.header.source_id = sender->source_id;
+    header.frame_length = length;
+    header.total_chunks = (uint16_t)total_chunks;
+    header.chunk_size = chunk_size;
+    header.fec_group = fec_group;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    bool ok = true;
+    for (int i = 0; ok && i < total_chunks; i++) {
+        header.flags = 0;
+        header.chunk_id = (uint16_t)i;
+        header.payload_length = (uint16_t)wire_chunk_length(length, chunk_size, i);
+        ok = send_batch_chunk(&batch, &header, jpeg + (size_t)i * chunk_size);
+
+        // Close the group with its parity
+        if (ok && fec_group > 0 && (i % fec_group == fec_group - 1 || i == total_chunks - 1)) {
+            int group = i / fec_group;
+            header.flags = WIRE_CHUNK_PARITY;
+            header.chunk_id = (uint16_t)group;
+            header.payload_length =
+                (uint16_t)wire_chunk_length(length, chunk_size, (uint32_t)group * fec_group);
+            ok = send_batch_chunk(&batch, &header, parity + (size_t)group * chunk_size);
+        }
+    }
+    if (ok) ok = send_batch_flush(&batch);
+    free(parity);
+    stream_count_batch(sender, &batch);
+    if (!ok) return -1;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ChunkSendStats* stats = &sender->stats;
+    double elapsed = seconds_between(&start, &end);
+    stats->frames++;
+    stats->chunks += total_chunks + groups;
+    stats->send_seconds += elapsed;
+    if (elapsed > stats->max_send_seconds) stats->max_send_seconds = elapsed;
+
+    repair_history_store(&sender->repairs, frame_num, jpeg, length, chunk_size, fec_group);
+    return total_chunks + groups;
+}
+
+bool repair_history_init(RepairHistory* history) {
+    memset(history, 0, sizeof(*history));
+    for (int i = 0; i < REPAIR_HISTORY_FRAMES; i++) {
+        history->frames[i].data = (unsigned char*)malloc(WIRE_MAX_FRAME_BYTES);
+        if (!history->frames[i].data) {
+            repair_history_free(history);
+            return false;
+        }
+    }
+    return true;
+}
+
+void repair_history_free(RepairHistory* history) {
+    for (int i = 0; i < REPAIR_HISTORY_FRAMES; i++) {
+        free(history->frames[i].data);
+        history->frames[i].data = NULL;
+    }
+}
+
+// Keeps a copy of a frame just sent, evicting the oldest held
+void repair_history_store(RepairHistory* history, int frame_num, const unsigned char* jpeg,
+                          uint32_t length, uint16_t chunk_size, uint16_t fec_group) {
+    if (length > WIRE_MAX_FRAME_BYTES) return;
+    SentFrame* sent = &history->frames[frame_num % REPAIR_HISTORY_FRAMES];
+    memcpy(sent->data, jpeg, length);
+    sent->length = length;
+    sent->frame_num = frame_num;
+    sent->chunk_size = chunk_size;
+    sent->fec_group = fec_group;
+    clock_gettime(CLOCK_MONOTONIC, &sent->sent_at);
+}
+
+// Who a NACK or REPORT from `from` speaks for: the subscriber it came from
+// or, from a receiver of a multicast target, the group. NULL = nobody the
+// stream goes to.
+static Subscriber* stream_requester(StreamSender* sender, const struct sockaddr_in* from) {
+    Subscriber* requester = subscriber_lookup(&sender->subscribers, from);
+    return requester ? requester : subscriber_group_for(&sender->subscribers, from);
+}
+
+// Resends the chunks one NACK asks for, to the subscriber that sent it, or
+// to the whole group for a multicast receiver (the others likely miss the
+// same chunks). NACKs from anyone else are dropped (a forged source
+// address would turn a small NACK into a frame's worth of datagrams at a
+// third party), and a subscriber or group gets at most REPAIR_MAX_RESENDS
+// chunks of each frame resent.
+static void answer_nack(StreamSender* sender, const WireNack* nack,
+                        const struct sockaddr_in* from) {
+    RepairHistory* history = &sender->repairs;
+    uint32_t frame_num = nack->header.frame_id;
+    history->nacks++;
+    Subscriber* requester = stream_requester(sender, from);
+    if (!requester) {
+        history->nacks_refused++;
+        return;
+    }
+    int held = frame_num % REPAIR_HISTORY_FRAMES;
+    SentFrame* sent = &history->frames[held];
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (sent->frame_num == 0 || (uint32_t)sent->frame_num != frame_num ||
+        seconds_between(&sent->sent_at, &now) * 1000.0 > WIRE_REPAIR_DEADLINE_MS) {
+        history->nacks_expired++;
+        return;
+    }
+
+    if (requester->resend_frame[held] != (int)frame_num) {
+        requester->resend_frame[held] = (int)frame_num;
+        requester->resent[held] = 0;
+    }
+    static SendBatch batch;
+    send_batch_init(&batch, sender, requester, 1);
+    batch.resend = true;
+
+    WireChunkHeader header;
+    memset(&header, 0, sizeof(header));
+    header.header.frame_id = frame_num;
+    header.header.timestamp_ns = wire_realtime_ns();
+    header.header.source_id = sender->source_id;
+    header.frame_length = sent->length;
+    header.total_chunks = wire_chunk_count(sent->length, sent->chunk_size);
+    header.chunk_size = sent->chunk_size;
+    header.fec_group = sent->fec_group;
+
+    bool ok = true;
+    for (int i = 0; ok && i < nack->chunk_count; i++) {
+        int chunk_id = nack->first_chunk + i;
+        if (!wire_nack_missing(nack, i) || chunk_id >= header.total_chunks) continue;
+        if (requester->resent[held] >= REPAIR_MAX_RESENDS) {
+            history->chunks_refused++;
+            continue;
+        }
+        requester->resent[held]++;
+        header.chunk_id = (uint16_t)chunk_id;
+        header.payload_length = (uint16_t)wire_chunk_length(sent->length, sent->chunk_size,
+                                                            chunk_id);
+        ok = send_batch_chunk(&batch, &header, sent->data + (size_t)chunk_id * sent->chunk_size);
+        history->chunks_resent++;
+    }
+    if (ok) send_batch_flush(&batch);
+    stream_count_batch(sender, &batch);
+}
+
+// Hands `to` the cookie its SUBSCRIBEs must echo
+static void send_cookie(StreamSender* sender, const struct sockaddr_in* to, uint64_t now_ns) {
+    WireCookie cookie;
+    memset(&cookie, 0, sizeof(cookie));
+    cookie.header.timestamp_ns = wire_realtime_ns();    // Sequence 0: not part of the stream
+    cookie.header.source_id = sender->source_id;
+    cookie.cookie = subscriber_cookie(&sender->subscribers, to, now_ns);
+    uint8_t message[WIRE_COOKIE_SIZE];
+    size_t length = wire_cookie_encode(&cookie, message);
+    sendto(sender->sock, message, length, 0, (const struct sockaddr*)to, sizeof(*to));
+}
+
+// Joins, renews or drops the sender of a SUBSCRIBE, once it has echoed the
+// cookie sent to its address (see wire_protocol.h): until then it only
+// gets the cookie, so a forged source address gets nowhere
+static void answer_subscribe(StreamSender* sender, const WireSubscribe* subscribe,
+                             const struct sockaddr_in* from) {
+    char host[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &from->sin_addr, host, sizeof(host));
+
+    uint64_t now = wire_now_ns();
+    if (!subscriber_cookie_valid(&sender->subscribers, from, subscribe->cookie, now)) {
+        sender->subscribers.challenged++;
+        send_cookie(sender, from, now);
+        return;
+    }
+    // Last epoch's cookie still counts; hand out this one's
+    if (subscribe->cookie != subscriber_cookie(&sender->subscribers, from, now)) {
+        send_cookie(sender, from, now);
+    }
+
+    if (subscribe->flags & WIRE_SUBSCRIBE_LEAVE) {
+        if (subscriber_leave(&sender->subscribers, from)) {
+            printf("[Subscribers] %s:%d left (%d subscribed)\n", host, ntohs(from->sin_port),
+                   sender->subscribers.count);
+        }
+        return;
+    }
+
+    uint64_t lease_end = now + WIRE_SUBSCRIBE_LEASE_MS * 1000000ULL;
+    int joined = subscriber_join(&sender->subscribers, from, lease_end);
+    if (joined > 0) {
+        printf("[Subscribers] ✓ %s:%d joined (%d subscribed)\n", host, ntohs(from->sin_port),
+               sender->subscribers.count);
+    } else if (joined < 0) {
+        printf("[Subscribers] Warning: %s:%d refused, %d subscribers already\n",
+               host, ntohs(from->sin_port), MAX_SUBSCRIBERS);
+    }
+}
+
+// Waits up to timeout_ns for client messages on the streams' socket and
+// answers every one that is queued: NACKs get their chunks resent,
+// SUBSCRIBEs update the registry, REPORTs feed the rate controller. The
+// streams of every feed share the socket; a message goes to
+// senders[header.source_id], and one naming a feed there is none of is
+// dropped. NACKs and REPORTs count only from subscribers and multicast
+// group receivers. Returns the number of messages handled. The wait is to
+// the nanosecond (ppoll), so a sender waiting for its next frame tick is
+// not woken up to a millisecond late.
+int serve_stream_requests(StreamSender* senders, int sender_count, long long timeout_ns) {
+    struct pollfd pfd;
+    pfd.fd = senders[0].sock;
+    pfd.events = POLLIN;
+    struct timespec timeout;
+    timeout.tv_sec = timeout_ns > 0 ? timeout_ns / 1000000000LL : 0;
+    timeout.tv_nsec = timeout_ns > 0 ? timeout_ns % 1000000000LL : 0;
+    if (ppoll(&pfd, 1, &timeout, NULL) <= 0) return 0;
+
+    int handled = 0;
+    uint8_t message[WIRE_NACK_MAX_SIZE];
+    struct sockaddr_in from;
+    socklen_t from_len = sizeof(from);
+    ssize_t received;
+    while ((received = recvfrom(pfd.fd, message, sizeof(message), MSG_DONTWAIT,
+                                (struct sockaddr*)&from, &from_len)) > 0) {
+        from_len = sizeof(from);
+        WireHeader header;
+        if (!wire_header_decode(message, (size_t)received, &header) ||
+            header.source_id >= sender_count) {
+            continue;
+        }
+        StreamSender* sender = &senders[header.source_id];
+        WireNack nack;
+        WireSubscribe subscribe;
+        WireReport report;
+        if (wire_nack_decode(message, (size_t)received, &nack)) {
+            answer_nack(sender, &nack, &from);
+            handled++;
+        } else if (wire_subscribe_decode(message, (size_t)received, &subscribe)) {
+            answer_subscribe(sender, &subscribe, &from);
+            handled++;
+        } else if (wire_report_decode(message, (size_t)received, &report)) {
+            // A forged REPORT must not pull every subscriber down the ladder
+            if (stream_requester(sender, &from)) {
+                rate_controller_report(&sender->rate, &report, &from, wire_now_ns());
+            } else {
+                sender->rate.reports_refused++;
+            }
+            handled++;
+        }
+    }
+    return handled;
+}
+
+void print_subscriber_stats(const char* label, const SubscriberRegistry* registry) {
+    printf("%s %d subscribed | %ld joined, %ld left, %ld timed out, %ld unreachable | "
+           "%ld SUBSCRIBEs answered with a cookie\n",
+           label, registry->count, registry->joined, registry->left, registry->expired,
+           registry->evicted, registry->challenged);
+}
+
+void print_repair_stats(const char* label, const RepairHistory* history) {
+    printf("%s %ld NACKs | %ld chunks resent | %ld too late to repair | "
+           "%ld from non-subscribers | %ld chunks over the per-frame limit\n",
+           label, history->nacks, history->chunks_resent, history->nacks_expired,
+           history->nacks_refused, history->chunks_refused);
+}
+
+void print_chunk_send_stats(const char* label, const ChunkSendStats* stats) {
+    if (stats->frames == 0) return;
+    printf("%s %ld frames | %.1f chunks/frame | %.1f datagrams/frame | %.1f KB/frame on the wire | "
+           "%.2f syscalls/frame | send latency avg %.2f ms, max %.2f ms\n",
+           label, stats->frames, (double)stats->chunks / stats->frames,
+           (double)stats->datagrams / stats->frames, stats->wire_bytes / 1024.0 / stats->frames,
+           (double)stats->syscalls / stats->frames,
+           stats->send_seconds * 1000.0 / stats->frames, stats->max_send_seconds * 1000.0);
+    if (stats->offloaded > 0) {
+        printf("%s %.0f%% of datagrams split by the kernel (UDP_SEGMENT)\n",
+               label, 100.0 * stats->offloaded / stats->datagrams);
+    }
+    if (stats->send_failures > 0) {
+        printf("%s %ld sends refused for one destination and skipped\n",
+               label, stats->send_failures);
+    }
+}
+
+// The original transmit loop: one padded FrameChunk per sendto(),
+// usleep(1000) after each
+static int send_frame_chunks_per_packet(int sock, const struct sockaddr_in* dest, int frame_num,
+                                        const unsigned char* jpeg, uint32_t length,
+                                        ChunkSendStats* stats) {
+    int total_chunks = (length + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int chunk_id = 0; chunk_id < total_chunks; chunk_id++) {
+        uint32_t offset = (uint32_t)chunk_id * CHUNK_SIZE;
+        uint32_t bytes = length - offset < CHUNK_SIZE ? length - offset : CHUNK_SIZE;
+
+        FrameChunk chunk;
+        memset(&chunk, 0, sizeof(chunk));
+        chunk.frame_num = frame_num;
+        chunk.chunk_id = chunk_id;
+        chunk.total_chunks = total_chunks;
+        chunk.chunk_size = bytes;
+        memcpy(chunk.data, jpeg + offset, bytes);
+
+        sendto(sock, &chunk, sizeof(FrameChunk), 0, (const struct sockaddr*)dest, sizeof(*dest));
+        usleep(1000);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed = seconds_between(&start, &end);
+    stats->frames++;
+    stats->chunks += total_chunks;
+    stats->syscalls += total_chunks;
+    stats->datagrams += total_chunks;
+    stats->wire_bytes += (long)total_chunks * sizeof(FrameChunk);
+    stats->send_seconds += elapsed;
+    if (elapsed > stats->max_send_seconds) stats->max_send_seconds = elapsed;
+    return total_chunks;
+}
+
+// A receiving socket bound to an ephemeral loopback port (its address in
+// *dest) and a socket to send to it from
+static bool open_loopback_pair(int* rx, int* tx, struct sockaddr_in* dest) {
+    *rx = socket(AF_INET, SOCK_DGRAM, 0);
+    *tx = socket(AF_INET, SOCK_DGRAM, 0);
+    if (*rx < 0 || *tx < 0) {
+        perror("[Benchmark] Socket creation failed");
+        if (*rx >= 0) close(*rx);
+        if (*tx >= 0) close(*tx);
+        return false;
+    }
+
+    memset(dest, 0, sizeof(*dest));
+    dest->sin_family = AF_INET;
+    dest->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    dest->sin_port = 0;
+    socklen_t dest_len = sizeof(*dest);
+    if (bind(*rx, (struct sockaddr*)dest, sizeof(*dest)) < 0 ||
+        getsockname(*rx, (struct sockaddr*)dest, &dest_len) < 0) {
+        perror("[Benchmark] Cannot bind local receiver");
+        close(*rx);
+        close(*tx);
+        return false;
+    }
+    return true;
+}
+
+static unsigned char* make_bench_frame() {
+    unsigned char* frame = (unsigned char*)malloc(BENCH_CHUNK_FRAME_BYTES);
+    for (int i = 0; frame && i < BENCH_CHUNK_FRAME_BYTES; i++) {
+        frame[i] = (unsigned char)(i * 31);
+    }
+    return frame;
+}
+
+// --bench-chunks: BENCH_CHUNK_FRAMES frames of BENCH_CHUNK_FRAME_BYTES sent
+// to a local socket: padded per-chunk sendto(), then batched sendmmsg() with
+// the old 1 KB payload and with payloads sized for a CHUNK_PATH_MTU link.
+// (Loopback's own 64 KB MTU would hide the packet count a real link pays.)
+void benchmark_chunk_send() {
+    int rx, tx;
+    struct sockaddr_in dest;
+    if (!open_loopback_pair(&rx, &tx, &dest)) return;
+    unsigned char* frame = make_bench_frame();
+
+    printf("\n[Benchmark] Chunk transmission: %d frames of %d bytes to 127.0.0.1:%d\n",
+           BENCH_CHUNK_FRAMES, BENCH_CHUNK_FRAME_BYTES, ntohs(dest.sin_port));
+
+    ChunkSendStats before;
+    memset(&before, 0, sizeof(before));
+    for (int n = 1; n <= BENCH_CHUNK_FRAMES; n++) {
+        send_frame_chunks_per_packet(tx, &dest, n, frame, BENCH_CHUNK_FRAME_BYTES, &before);
+    }
+
+    TokenBucket bucket;
+    token_bucket_init(&bucket, STREAM_SEND_RATE, STREAM_SEND_BURST);  // Sizes the rate controller
+    StreamSender fixed, sized;
+    uint16_t mtu_payload = wire_chunk_payload_for_mtu(CHUNK_PATH_MTU);
+    if (!stream_sender_init(&fixed, tx, CHUNK_SIZE, 0, &bucket) ||
+        !stream_sender_init(&sized, tx, mtu_payload, 0, &bucket)) {
+        printf("[Benchmark] Error: Cannot allocate repair history\n");
+        free(frame);
+        close(rx);
+        close(tx);
+        return;
+    }
+    subscriber_join(&fixed.subscribers, &dest, 0);
+    subscriber_join(&sized.subscribers, &dest, 0);
+
+    token_bucket_init(&bucket, STREAM_SEND_RATE, STREAM_SEND_BURST);
+    for (int n = 1; n <= BENCH_CHUNK_FRAMES; n++) {
+        send_frame_chunks(&fixed, n, frame, BENCH_CHUNK_FRAME_BYTES);
+    }
+    token_bucket_init(&bucket, STREAM_SEND_RATE, STREAM_SEND_BURST);
+    for (int n = 1; n <= BENCH_CHUNK_FRAMES; n++) {
+        send_frame_chunks(&sized, n, frame, BENCH_CHUNK_FRAME_BYTES);
+    }
+
+    char label[64];
+    print_chunk_send_stats("[Benchmark] sendto + usleep, padded 1024 B:", &before);
+    print_chunk_send_stats("[Benchmark] sendmmsg, unpadded 1024 B:    ", &fixed.stats);
+    snprintf(label, sizeof(label), "[Benchmark] sendmmsg, MTU %d -> %u B:", CHUNK_PATH_MTU, mtu_payload);
+    print_chunk_send_stats(label, &sized.stats);
+    printf("[Benchmark] (batched paths: token bucket %.1f MB/s, %d KB burst, %d chunks per batch)\n\n",
+           STREAM_SEND_RATE / (1024.0 * 1024.0), (int)(STREAM_SEND_BURST / 1024), CHUNK_BATCH);
+
+    stream_sender_free(&fixed);
+    stream_sender_free(&sized);
+    free(frame);
+    close(rx);
+    close(tx);
+}
+
+// Drains the receiving socket into the reassembler, dropping each datagram
+// with probability loss. Returns the number of frames rebuilt byte-exact.
+static int drain_lossy(int rx, WireReassembler* reassembler, const unsigned char* frame,
+                       double loss, unsigned int* seed, uint64_t now_ns) {
+    static uint8_t datagram[WIRE_MAX_DATAGRAM];
+    int intact = 0;
+    ssize_t received;
+    while ((received = recv(rx, datagram, sizeof(datagram), MSG_DONTWAIT)) > 0) {
+        if (rand_r(seed) < loss * RAND_MAX) continue;       // Injected loss
+        const WireFrameSlot* slot = wire_reassembler_add(reassembler, datagram,
+                                                         (size_t)received, now_ns);
+        if (slot && memcmp(slot->data, frame, BENCH_CHUNK_FRAME_BYTES) == 0) intact++;
+    }
+    return intact;
+}
+
+// Sends BENCH_FEC_FRAMES frames with the given FEC group over loopback,
+// dropping datagrams (NACKs included) with probability loss, and returns
+// the share of frames rebuilt byte-exact. With nack, the receiver runs its
+// NACK rounds on a simulated clock (frame n arrives at n / FPS seconds) and
+// the sender answers them. *overhead gets the extra bytes on the wire, both
+// directions, relative to the frame bytes.
+static double run_loss_trial(int rx, int tx, const struct sockaddr_in* dest,
+                             const unsigned char* frame, uint16_t chunk_size,
+                             uint16_t fec_group, bool nack, double loss, double* overhead) {
+    TokenBucket unlimited;
+    token_bucket_init(&unlimited, 0, 0);
+    WireReassembler reassembler;
+    StreamSender sender;
+    if (!wire_reassembler_init(&reassembler)) return 0;
+    if (!stream_sender_init(&sender, tx, chunk_size, fec_group, &unlimited)) {
+        wire_reassembler_free(&reassembler);
+        return 0;
+    }
+    subscriber_join(&sender.subscribers, dest, 0);
+
+    unsigned int seed = 12345;
+    uint32_t nack_sequence = 1;
+    long nack_bytes = 0;
+    int intact = 0;
+    const uint64_t ms = 1000000ULL;
+
+    // NACKs go from the receiving socket back to the sending one
+    struct sockaddr_in source;
+    socklen_t source_len = sizeof(source);
+
+    for (int n = 1; n <= BENCH_FEC_FRAMES; n++) {
+        uint64_t arrival = (uint64_t)n * (1000 / FPS) * ms;
+        send_frame_chunks(&sender, n, frame, BENCH_CHUNK_FRAME_BYTES);
+        intact += drain_lossy(rx, &reassembler, frame, loss, &seed, arrival);
+        if (!nack) continue;
+
+        getsockname(tx, (struct sockaddr*)&source, &source_len);
+        source.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        for (uint64_t now = arrival + WIRE_NACK_DELAY_MS * ms;
+             now < arrival + WIRE_REPAIR_DEADLINE_MS * ms; now += WIRE_NACK_RETRY_MS * ms) {
+            WireNack request;
+            while (wire_reassembler_next_nack(&reassembler, now, &request)) {
+                uint8_t message[WIRE_NACK_MAX_SIZE];
+                request.header.sequence = nack_sequence++;
+                request.header.timestamp_ns = wire_realtime_ns();
+                size_t length = wire_nack_encode(&request, message);
+                nack_bytes += (long)length;
+                if (rand_r(&seed) < loss * RAND_MAX) continue;
+                sendto(rx, message, length, 0, (struct sockaddr*)&source, sizeof(source));
+            }
+            serve_stream_requests(&sender, 1, 0);
+            intact += drain_lossy(rx, &reassembler, frame, loss, &seed, now);
+        }
+    }
+
+    *overhead = (double)(sender.stats.wire_bytes + nack_bytes) /
+                ((double)BENCH_FEC_FRAMES * BENCH_CHUNK_FRAME_BYTES) - 1.0;
+    stream_sender_free(&sender);
+    wire_reassembler_free(&reassembler);
+    return (double)intact / BENCH_FEC_FRAMES;
+}
+
+// --bench-fec: frame completion rate against bandwidth overhead under
+// random datagram loss, for several parity group sizes with and without
+// NACK repair, chunked for a CHUNK_PATH_MTU link
+void benchmark_fec() {
+    static const struct {
+        int fec_group;
+        bool nack;
+    } schemes[] = {{0, false}, {16, false}, {8, false}, {4, false}, {2, false},
+                   {0, true}, {8, true}};
+    static const double losses[] = {0.01, 0.02, 0.03, 0.05};
+    const int scheme_count = sizeof(schemes) / sizeof(schemes[0]);
+    const int loss_count = sizeof(losses) / sizeof(losses[0]);
+
+    int rx, tx;
+    struct sockaddr_in dest;
+    if (!open_loopback_pair(&rx, &tx, &dest)) return;
+    int buffer = 4 * 1024 * 1024;
+    setsockopt(rx, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    unsigned char* frame = make_bench_frame();
+    uint16_t chunk_size = wire_chunk_payload_for_mtu(CHUNK_PATH_MTU);
+
+    printf("\n[Benchmark] Loss repair: %d frames of %d bytes in %u-byte chunks, random loss\n",
+           BENCH_FEC_FRAMES, BENCH_CHUNK_FRAME_BYTES, chunk_size);
+    printf("[Benchmark] %-14s", "repair");
+    for (int l = 0; l < loss_count; l++) printf("  %8.0f%% loss", losses[l] * 100.0);
+    printf("\n");
+
+    for (int r = 0; r < scheme_count; r++) {
+        char name[32];
+        if (schemes[r].fec_group == 0) {
+            snprintf(name, sizeof(name), "%s", schemes[r].nack ? "NACK" : "none");
+        } else {
+            snprintf(name, sizeof(name), "1 per %d%s", schemes[r].fec_group,
+                     schemes[r].nack ? " + NACK" : "");
+        }
+
+        printf("[Benchmark] %-14s", name);
+        for (int l = 0; l < loss_count; l++) {
+            double overhead = 0;
+            double completion = run_loss_trial(rx, tx, &dest, frame, chunk_size,
+                                               (uint16_t)schemes[r].fec_group, schemes[r].nack,
+                                               losses[l], &overhead);
+            printf("  %6.1f%% +%4.1f%%", completion * 100.0, overhead * 100.0);
+        }
+        printf("\n");
+    }
+    printf("[Benchmark] (frames rebuilt intact, +bytes on the wire; the live sender "
+           "uses 1 per %d + NACK)\n\n", CHUNK_FEC_GROUP);
+
+    free(frame);
+    close(rx);
+    close(tx);
+}
+
+// Reads every datagram queued on each receiving socket; returns how many
+// frames arrived complete on all of them
+static int drain_subscribers(const int* rx, int count, WireReassembler* reassemblers,
+                             const unsigned char* frame) {
+    static uint8_t datagram[WIRE_MAX_DATAGRAM];
+    int intact = 0;
+    for (int i = 0; i < count; i++) {
+        ssize_t received;
+        while ((received = recv(rx[i], datagram, sizeof(datagram), MSG_DONTWAIT)) > 0) {
+            const WireFrameSlot* slot = wire_reassembler_add(&reassemblers[i], datagram,
+                                                             (size_t)received, 0);
+            if (slot && memcmp(slot->data, frame, BENCH_CHUNK_FRAME_BYTES) == 0) intact++;
+        }
+    }
+    return intact;
+}
+
+// Sends BENCH_FANOUT_FRAMES frames to `count` loopback subscribers, either
+// as one StreamSender per subscriber (each frame chunked and sent once per
+// client, as a per-client unicast loop would) or as one sender with them
+// all in its registry. Receivers are drained between frames, untimed.
+static void run_fanout_trial(int tx, const int* rx, const struct sockaddr_in* dests, int count,
+                             const unsigned char* frame, uint16_t chunk_size, bool shared) {
+    TokenBucket unlimited;
+    token_bucket_init(&unlimited, 0, 0);
+    int senders = shared ? 1 : count;
+    StreamSender* sender = (StreamSender*)calloc(senders, sizeof(StreamSender));
+    WireReassembler* reassemblers = (WireReassembler*)calloc(count, sizeof(WireReassembler));
+    int ready = 0;
+    bool ok = sender && reassemblers;
+    for (int i = 0; ok && i < count; i++) {
+        ok = wire_reassembler_init(&reassemblers[i]);
+        if (ok) ready++;
+    }
+    int started = 0;
+    for (int s = 0; ok && s < senders; s++) {
+        ok = stream_sender_init(&sender[s], tx, chunk_size, CHUNK_FEC_GROUP, &unlimited);
+        if (ok) started++;
+    }
+    for (int i = 0; ok && i < count; i++) {
+        subscriber_join(&sender[shared ? 0 : i].subscribers, &dests[i], 0);
+    }
+    if (!ok) {
+        printf("[Benchmark] Error: Cannot allocate %d subscribers\n", count);
+    }
+
+    ChunkSendStats total;
+    memset(&total, 0, sizeof(total));
+    int intact = 0;
+    for (int n = 1; ok && n <= BENCH_FANOUT_FRAMES; n++) {
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int s = 0; s < senders; s++) {
+            send_frame_chunks(&sender[s], n, frame, BENCH_CHUNK_FRAME_BYTES);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double elapsed = seconds_between(&start, &end);
+        total.send_seconds += elapsed;
+        if (elapsed > total.max_send_seconds) total.max_send_seconds = elapsed;
+        intact += drain_subscribers(rx, count, reassemblers, frame);
+    }
+
+    for (int s = 0; s < started; s++) {
+        total.frames = sender[s].stats.frames;
+        total.chunks = sender[s].stats.chunks;
+        total.syscalls += sender[s].stats.syscalls;
+        total.datagrams += sender[s].stats.datagrams;
+        total.wire_bytes += sender[s].stats.wire_bytes;
+        stream_sender_free(&sender[s]);
+    }
+    for (int i = 0; i < ready; i++) wire_reassembler_free(&reassemblers[i]);
+    free(reassemblers);
+    free(sender);
+    if (!ok) return;
+
+    char label[64];
+    snprintf(label, sizeof(label), "[Benchmark] %3d x %-16s", count,
+             shared ? "encode once:" : "per subscriber:");
+    printf("%s %7.1f syscalls/frame | %7.0f datagrams/frame | send %6.2f ms/frame, max %6.2f ms"
+           " | %5.1f%% delivered\n",
+           label, (double)total.syscalls / BENCH_FANOUT_FRAMES,
+           (double)total.datagrams / BENCH_FANOUT_FRAMES,
+           total.send_seconds * 1000.0 / BENCH_FANOUT_FRAMES, total.max_send_seconds * 1000.0,
+           100.0 * intact / ((double)BENCH_FANOUT_FRAMES * count));
+}
+
+// --bench-fanout: one frame stream to 1, 10 and 100 local subscribers, a
+// sender per subscriber against one sender fanning each encoded message
+// out to all of them in shared sendmmsg() batches
+void benchmark_fanout() {
+    static const int audiences[] = {1, 10, 100};
+    const int audience_count = sizeof(audiences) / sizeof(audiences[0]);
+    const int most = audiences[audience_count - 1];
+
+    int tx = socket(AF_INET, SOCK_DGRAM, 0);
+    int* rx = (int*)malloc(most * sizeof(int));
+    struct sockaddr_in* dests = (struct sockaddr_in*)calloc(most, sizeof(struct sockaddr_in));
+    unsigned char* frame = make_bench_frame();
+    int opened = 0;
+    if (tx < 0 || !rx || !dests || !frame) {
+        perror("[Benchmark] Cannot set up fan-out");
+    } else {
+        int buffer = 1024 * 1024;
+        for (; opened < most; opened++) {
+            rx[opened] = socket(AF_INET, SOCK_DGRAM, 0);
+            if (rx[opened] < 0) break;
+            setsockopt(rx[opened], SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+            dests[opened].sin_family = AF_INET;
+            dests[opened].sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t dest_len = sizeof(dests[opened]);
+            if (bind(rx[opened], (struct sockaddr*)&dests[opened], sizeof(dests[opened])) < 0 ||
+                getsockname(rx[opened], (struct sockaddr*)&dests[opened], &dest_len) < 0) {
+                close(rx[opened]);
+                break;
+            }
+        }
+        if (opened < most) perror("[Benchmark] Cannot bind local subscribers");
+    }
+
+    if (opened == most) {
+        uint16_t chunk_size = wire_chunk_payload_for_mtu(CHUNK_PATH_MTU);
+        printf("\n[Benchmark] Fan-out: %d frames of %d bytes in %u-byte chunks, FEC 1/%d\n",
+               BENCH_FANOUT_FRAMES, BENCH_CHUNK_FRAME_BYTES, chunk_size, CHUNK_FEC_GROUP);
+        for (int a = 0; a < audience_count; a++) {
+            run_fanout_trial(tx, rx, dests, audiences[a], frame, chunk_size, false);
+            run_fanout_trial(tx, rx, dests, audiences[a], frame, chunk_size, true);
+        }
+        printf("[Benchmark] (unpaced; up to %d datagrams per sendmmsg())\n\n",
+               SEND_BATCH_MESSAGES);
+    }
+
+    for (int i = 0; i < opened; i++) close(rx[i]);
+    if (tx >= 0) close(tx);
+    free(frame);
+    free(dests);
+    free(rx);
+}
+
+static double thread_cpu_seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Sends BENCH_GSO_FRAMES frames over loopback and reads them back, with or
+// without segmentation offload on each side, and reports the CPU time each
+// side spent per frame. Loopback delivery runs in the sender's syscalls,
+// so the send figure includes the kernel's receive path.
+static void run_offload_trial(const char* name, bool offload, bool gro,
+                              const unsigned char* frame, uint16_t chunk_size) {
+    int rx, tx;
+    struct sockaddr_in dest;
+    if (!open_loopback_pair(&rx, &tx, &dest)) return;
+    int buffer = 4 * 1024 * 1024;
+    setsockopt(rx, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+
+    TokenBucket unlimited;
+    token_bucket_init(&unlimited, 0, 0);
+    StreamSender sender;
+    WireReassembler reassembler;
+    bool sender_ready = stream_sender_init(&sender, tx, chunk_size, CHUNK_FEC_GROUP, &unlimited);
+    bool reassembler_ready = wire_reassembler_init(&reassembler);
+    if (!sender_ready || !reassembler_ready) {
+        printf("[Benchmark] %-26s cannot allocate buffers\n", name);
+    } else if (offload && !stream_sender_enable_offload(&sender)) {
+        printf("[Benchmark] %-26s UDP_SEGMENT not supported by this kernel\n", name);
+    } else if (gro && !wire_enable_gro(rx)) {
+        printf("[Benchmark] %-26s UDP_GRO not supported by this kernel\n", name);
+    } else {
+        subscriber_join(&sender.subscribers, &dest, 0);
+        static uint8_t datagram[WIRE_MAX_DATAGRAM];
+        double send_cpu = 0, receive_cpu = 0;
+        long reads = 0;
+        int intact = 0;
+        for (int n = 1; n <= BENCH_GSO_FRAMES; n++) {
+            double start = thread_cpu_seconds();
+            send_frame_chunks(&sender, n, frame, BENCH_CHUNK_FRAME_BYTES);
+            double sent = thread_cpu_seconds();
+
+            ssize_t received;
+            size_t segment;
+            while ((received = wire_receive(rx, datagram, sizeof(datagram), NULL, &segment)) > 0) {
+                reads++;
+                for (size_t offset = 0; offset < (size_t)received; offset += segment) {
+                    size_t length = (size_t)received - offset < segment ?
+                                    (size_t)received - offset : segment;
+                    const WireFrameSlot* slot = wire_reassembler_add(&reassembler,
+                                                                     datagram + offset, length, 0);
+                    if (slot && memcmp(slot->data, frame, BENCH_CHUNK_FRAME_BYTES) == 0) intact++;
+                }
+            }
+            send_cpu += sent - start;
+            receive_cpu += thread_cpu_seconds() - sent;
+        }
+        printf("[Benchmark] %-26s send %6.1f us CPU/frame (%4.1f syscalls) | "
+               "receive %6.1f us CPU/frame (%4.1f reads) | %5.1f%% intact\n",
+               name, send_cpu * 1e6 / BENCH_GSO_FRAMES,
+               (double)sender.stats.syscalls / BENCH_GSO_FRAMES,
+               receive_cpu * 1e6 / BENCH_GSO_FRAMES, (double)reads / BENCH_GSO_FRAMES,
+               100.0 * intact / BENCH_GSO_FRAMES);
+    }
+
+    if (reassembler_ready) wire_reassembler_free(&reassembler);
+    if (sender_ready) stream_sender_free(&sender);
+    close(rx);
+    close(tx);
+}
+
+// --bench-gso: CPU per frame with the kernel splitting runs of chunks
+// (UDP_SEGMENT) and handing them back whole (UDP_GRO), against one
+// datagram per chunk on both sides
+void benchmark_segmentation() {
+    unsigned char* frame = make_bench_frame();
+    if (!frame) return;
+    uint16_t chunk_size = wire_chunk_payload_for_mtu(CHUNK_PATH_MTU);
+
+    printf("\n[Benchmark] Segmentation offload: %d frames of %d bytes in %u-byte chunks, FEC 1/%d\n",
+           BENCH_GSO_FRAMES, BENCH_CHUNK_FRAME_BYTES, chunk_size, CHUNK_FEC_GROUP);
+    run_offload_trial("sendmmsg -> recvmsg:", false, false, frame, chunk_size);
+    run_offload_trial("sendmmsg -> UDP_GRO:", false, true, frame, chunk_size);
+    run_offload_trial("UDP_SEGMENT -> recvmsg:", true, false, frame, chunk_size);
+    run_offload_trial("UDP_SEGMENT -> UDP_GRO:", true, true, frame, chunk_size);
+    printf("[Benchmark] (unpaced; up to %d chunks per run, loopback MTU)\n\n", CHUNK_BATCH);
+    free(frame);
+}
@@ -0,0 +1,188 @@
+#include "../include/aviation_system.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+// Archive layout: [header][index: frame_count entries][JPEG payloads back to back]
+// Frame numbers are 1-based like the old frame_%03d.jpg files. Each frame is
+// stored in rendition_count sizes (smallest first); the index entry holds the
+// offset and length of every rendition plus the frame's sensor record.
+
+static bool write_all(int fd, const void* data, size_t length) {
+    const char* p = (const char*)data;
+    while (length > 0) {
+        ssize_t n = write(fd, p, length);
+        if (n < 0) return false;
+        p += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+// frames/lengths hold frame_count * RENDITION_COUNT payloads, frame-major
+bool frame_archive_write(const char* path, int frame_count,
+                         const unsigned char* const* frames, const uint32_t* lengths,
+                         const SensorData* sensors) {
+    static const int widths[RENDITION_COUNT] = RENDITION_WIDTHS;
+    static const int heights[RENDITION_COUNT] = RENDITION_HEIGHTS;
+
+    char tmp_path[256];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    int fd = open(tmp_path, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror("[FrameArchive] Cannot create archive");
+        return false;
+    }
+
+    FrameArchiveHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = FRAME_ARCHIVE_MAGIC;
+    header.version = FRAME_ARCHIVE_VERSION;
+    header.frame_count = frame_count;
+    header.frame_width = widths[DEFAULT_RENDITION];
+    header.frame_height = heights[DEFAULT_RENDITION];
+    header.fps = FPS;
+    header.rendition_count = RENDITION_COUNT;
+    header.default_rendition = DEFAULT_RENDITION;
+    for (int r = 0; r < RENDITION_COUNT; r++) {
+        header.rendition_width[r] = widths[r];
+        header.rendition_height[r] = heights[r];
+    }
+    header.index_offset = sizeof(FrameArchiveHeader);
+    header.payload_offset = header.index_offset + (uint64_t)frame_count * sizeof(FrameIndexEntry);
+
+    FrameIndexEntry* index = (FrameIndexEntry*)calloc(frame_count > 0 ? frame_count : 1,
+                                                      sizeof(FrameIndexEntry));
+    if (!index) {
+        close(fd);
+        unlink(tmp_path);
+        return false;
+    }
+
+    uint64_t offset = header.payload_offset;
+    for (int i = 0; i < frame_count; i++) {
+        for (int r = 0; r < RENDITION_COUNT; r++) {
+            index[i].offset[r] = offset;
+            index[i].length[r] = lengths[i * RENDITION_COUNT + r];
+            offset += index[i].length[r];
+        }
+        if (sensors) {
+            index[i].sensor = sensors[i];
+        }
+    }
+
+    bool ok = write_all(fd, &header, sizeof(header)) &&
+              write_all(fd, index, (size_t)frame_count * sizeof(FrameIndexEntry));
+    for (int i = 0; ok && i < frame_count * RENDITION_COUNT; i++) {
+        ok = write_all(fd, frames[i], lengths[i]);
+    }
+
+    free(index);
+    close(fd);
+
+    if (!ok || rename(tmp_path, path) != 0) {
+        perror("[FrameArchive] Cannot write archive");
+        unlink(tmp_path);
+        return false;
+    }
+
+    printf("[FrameArchive] ✓ Wrote %d frames to %s (%.1f KB)\n",
+           frame_count, path, offset / 1024.0);
+    return true;
+}
+
+bool frame_archive_open(FrameArchive* archive, const char* path) {
+    memset(archive, 0, sizeof(*archive));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(FrameArchiveHeader)) {
+        close(fd);
+        return false;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    void* base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+
+    const FrameArchiveHeader* header = (const FrameArchiveHeader*)base;
+    size_t size = st.st_size;
+    uint64_t index_end = header->index_offset +
+                         (uint64_t)header->frame_count * sizeof(FrameIndexEntry);
+
+    if (header->magic != FRAME_ARCHIVE_MAGIC || header->version != FRAME_ARCHIVE_VERSION ||
+        header->rendition_count < 1 || header->rendition_count > MAX_RENDITIONS ||
+        header->default_rendition >= header->rendition_count || index_end > size) {
+        fprintf(stderr, "[FrameArchive] %s is not a valid frame archive\n", path);
+        munmap(base, size);
+        return false;
+    }
+
+    const FrameIndexEntry* index = (const FrameIndexEntry*)((const char*)base + header->index_offset);
+    for (uint32_t i = 0; i < header->frame_count; i++) {
+        for (uint32_t r = 0; r < header->rendition_count; r++) {
+            if (index[i].offset[r] + index[i].length[r] > size) {
+                fprintf(stderr, "[FrameArchive] %s: frame %u out of bounds\n", path, i + 1);
+                munmap(base, size);
+                return false;
+            }
+        }
+    }
+
+    archive->base = base;
+    archive->size = size;
+    archive->header = header;
+    archive->index = index;
+    return true;
+}
+
+const unsigned char* frame_archive_rendition(const FrameArchive* archive, int frame_number,
+                                             int rendition, uint32_t* length) {
+    if (!archive->base || frame_number < 1 || frame_number > (int)archive->header->frame_count ||
+        rendition < 0 || rendition >= (int)archive->header->rendition_count) {
+        return NULL;
+    }
+
+    const FrameIndexEntry* entry = &archive->index[frame_number - 1];
+    *length = entry->length[rendition];
+    return (const unsigned char*)archive->base + entry->offset[rendition];
+}
+
+// Default rendition (320x240), what every consumer used before renditions
+const unsigned char* frame_archive_frame(const FrameArchive* archive, int frame_number,
+                                         uint32_t* length) {
+    if (!archive->base) return NULL;
+    return frame_archive_rendition(archive, frame_number,
+                                   archive->header->default_rendition, length);
+}
+
+// Largest rendition no wider than max_width (the smallest one if none fits)
+int frame_archive_pick_rendition(const FrameArchive* archive, int max_width) {
+    int best = 0;
+    for (uint32_t r = 1; r < archive->header->rendition_count; r++) {
+        if ((int)archive->header->rendition_width[r] <= max_width) {
+            best = r;
+        }
+    }
+    return best;
+}
+
+const SensorData* frame_archive_sensor(const FrameArchive* archive, int frame_number) {
+    if (!archive->base || frame_number < 1 || frame_number > (int)archive->header->frame_count) {
+        return NULL;
+    }
+    return &archive->index[frame_number - 1].sensor;
+}
+
+void frame_archive_close(FrameArchive* archive) {
+    if (archive->base) {
+        munmap(archive->base, archive->size);
+    }
+    archive->base = NULL;
+}
@@ -0,0 +1,234 @@
+#include "../include/aviation_system.h"
+
+// Process-wide frame cache: every encoded frame is copied once into a
+// preallocated arena and borrowed by all consumers (the frame sender, which
+// fans it out to every subscriber, and the dashboard). Frame n lives in slot
+// n % FRAME_CACHE_SLOTS. A prefetch thread loads frames ahead of the
+// playback cursor; a slot is only reused (evicting the frame behind the
+// cursor) once nobody holds a reference to it.
+
+static bool frame_cache_running(FrameCache* cache) {
+    return !cache->stop && cache->shm->system_active;
+}
+
+static void frame_cache_wait(FrameCache* cache) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += 200000000;  // Re-check shutdown every 200ms
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+    pthread_cond_timedwait(&cache->changed, &cache->mutex, &deadline);
+}
+
+// Waits (mutex held) until the slot for frame_number has no borrowers,
+// then fills it. Returns false on shutdown.
+static bool frame_cache_store(FrameCache* cache, int frame_number, const unsigned char* data,
+                              uint32_t length, const SensorData* sensor,
+                              const FrameTimes* times) {
+    FrameCacheEntry* entry = &cache->entries[frame_number % FRAME_CACHE_SLOTS];
+    while (entry->refcount > 0) {
+        if (!frame_cache_running(cache)) return false;
+        frame_cache_wait(cache);
+    }
+
+    if (length > FRAME_CACHE_SLOT_BYTES) {
+        printf("[FrameCache] Warning: Frame %d (%u bytes) exceeds slot size\n",
+               frame_number, length);
+        length = 0;
+    }
+    memcpy(entry->data, data, length);
+    entry->length = length;
+    entry->sensor = *sensor;
+    entry->times = *times;
+    entry->frame_number = frame_number;
+    cache->newest = frame_number;
+    pthread_cond_broadcast(&cache->changed);
+    return true;
+}
+
+// Archive mode: stay FRAME_CACHE_PREFETCH frames ahead of the cursor
+static void frame_cache_prefetch_archive(FrameCache* cache) {
+    int frame_count = (int)cache->archive.header->frame_count;
+
+    pthread_mutex_lock(&cache->mutex);
+    while (frame_cache_running(cache) && cache->newest < frame_count) {
+        if (cache->newest >= cache->cursor + FRAME_CACHE_PREFETCH) {
+            frame_cache_wait(cache);
+            continue;
+        }
+
+        int next = cache->newest + 1;
+        uint32_t length = 0;
+        const unsigned char* jpeg = frame_archive_rendition(&cache->archive, next,
+                                                            cache->rendition, &length);
+        const SensorData* sensor = frame_archive_sensor(&cache->archive, next);
+        // Archived frames were encoded long ago; the sender stamps them as
+        // they go out, not here up to FRAME_CACHE_PREFETCH frames early
+        FrameTimes times;
+        times.capture_ns = 0;
+        times.encode_ns = 0;
+        if (!frame_cache_store(cache, next, jpeg, length, sensor, &times)) break;
+    }
+    cache->source_done = true;
+    pthread_cond_broadcast(&cache->changed);
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+// Live mode: the cache is the ring's only reader and follows the producer
+static void frame_cache_prefetch_ring(FrameCache* cache) {
+    unsigned char* staging = malloc(LIVE_SLOT_BYTES);
+    int next = 1;
+
+    while (staging && frame_cache_running(cache)) {
+        uint32_t length;
+        SensorData sensor;
+        FrameTimes times;
+        if (!frame_ring_read(cache->ring, cache->shm, &next, staging, &length, &sensor, &times)) {
+            break;
+        }
+
+        pthread_mutex_lock(&cache->mutex);
+        bool stored = frame_cache_store(cache, next, staging, length, &sensor, &times);
+        pthread_mutex_unlock(&cache->mutex);
+        if (!stored) break;
+        next++;
+    }
+
+    pthread_mutex_lock(&cache->mutex);
+    cache->source_done = true;
+    pthread_cond_broadcast(&cache->changed);
+    pthread_mutex_unlock(&cache->mutex);
+    free(staging);
+}
+
+static void* frame_cache_prefetch_thread(void* arg) {
+    FrameCache* cache = (FrameCache*)arg;
+    if (cache->ring) {
+        frame_cache_prefetch_ring(cache);
+    } else {
+        frame_cache_prefetch_archive(cache);
+    }
+    return NULL;
+}
+
+// ring == NULL caches the archive at FRAME_ARCHIVE_PATH instead
+FrameCache* frame_cache_create(SharedMemory* shm, FrameRing* ring) {
+    FrameCache* cache = calloc(1, sizeof(FrameCache));
+    if (!cache) return NULL;
+
+    cache->arena = malloc((size_t)FRAME_CACHE_SLOTS * FRAME_CACHE_SLOT_BYTES);
+    if (!cache->arena) {
+        free(cache);
+        return NULL;
+    }
+    for (int i = 0; i < FRAME_CACHE_SLOTS; i++) {
+        cache->entries[i].data = cache->arena + (size_t)i * FRAME_CACHE_SLOT_BYTES;
+    }
+
+    cache->shm = shm;
+    cache->ring = ring;
+    if (!ring) {
+        if (!frame_archive_open(&cache->archive, FRAME_ARCHIVE_PATH)) {
+            printf("[FrameCache] Error: Cannot map %s\n", FRAME_ARCHIVE_PATH);
+            free(cache->arena);
+            free(cache);
+            return NULL;
+        }
+        cache->rendition = frame_archive_pick_rendition(&cache->archive, FRAME_CACHE_WIDTH);
+    }
+
+    pthread_mutex_init(&cache->mutex, NULL);
+    pthread_cond_init(&cache->changed, NULL);
+    pthread_create(&cache->prefetcher, NULL, frame_cache_prefetch_thread, cache);
+
+    printf("[FrameCache] ✓ %d slots x %d KB arena, prefetching %d frames ahead (%s)\n",
+           FRAME_CACHE_SLOTS, FRAME_CACHE_SLOT_BYTES / 1024, FRAME_CACHE_PREFETCH,
+           ring ? "live ring" : FRAME_ARCHIVE_PATH);
+    return cache;
+}
+
+void frame_cache_destroy(FrameCache* cache) {
+    if (!cache) return;
+
+    pthread_mutex_lock(&cache->mutex);
+    cache->stop = true;
+    pthread_cond_broadcast(&cache->changed);
+    pthread_mutex_unlock(&cache->mutex);
+    pthread_join(cache->prefetcher, NULL);
+
+    frame_archive_close(&cache->archive);
+    pthread_mutex_destroy(&cache->mutex);
+    pthread_cond_destroy(&cache->changed);
+    free(cache->arena);
+    free(cache);
+}
+
+// Blocks until *frame_number is cached and takes a reference to it. A
+// borrower that fell behind the cached window (or asked for a frame the
+// live ring skipped) is moved forward and *frame_number updated.
+// Returns NULL once the source has no more frames or on shutdown.
+const FrameCacheEntry* frame_cache_borrow(FrameCache* cache, int* frame_number) {
+    pthread_mutex_lock(&cache->mutex);
+
+    if (*frame_number > cache->cursor) {
+        cache->cursor = *frame_number;
+        pthread_cond_broadcast(&cache->changed);
+    }
+
+    while (frame_cache_running(cache)) {
+        int oldest = cache->newest - FRAME_CACHE_SLOTS + 1;
+        if (*frame_number < oldest) {
+            *frame_number = oldest;
+        }
+
+        FrameCacheEntry* entry = &cache->entries[*frame_number % FRAME_CACHE_SLOTS];
+        if (entry->frame_number == *frame_number) {
+            entry->refcount++;
+            pthread_mutex_unlock(&cache->mutex);
+            return entry;
+        }
+
+        if (*frame_number <= cache->newest) {
+            (*frame_number)++;      // Never loaded (live ring overrun)
+            continue;
+        }
+        if (cache->source_done) break;
+        frame_cache_wait(cache);
+    }
+
+    pthread_mutex_unlock(&cache->mutex);
+    return NULL;
+}
+
+// Newest frame loaded so far (0 before the first); borrowing any frame up
+// to it does not block
+int frame_cache_newest(FrameCache* cache) {
+    pthread_mutex_lock(&cache->mutex);
+    int newest = cache->newest;
+    pthread_mutex_unlock(&cache->mutex);
+    return newest;
+}
+
+// Non-blocking: a reference to frame_number if it is cached, else NULL
+const FrameCacheEntry* frame_cache_try_borrow(FrameCache* cache, int frame_number) {
+    const FrameCacheEntry* result = NULL;
+    pthread_mutex_lock(&cache->mutex);
+    FrameCacheEntry* entry = &cache->entries[frame_number % FRAME_CACHE_SLOTS];
+    if (frame_number > 0 && entry->frame_number == frame_number) {
+        entry->refcount++;
+        result = entry;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+    return result;
+}
+
+void frame_cache_release(FrameCache* cache, const FrameCacheEntry* entry) {
+    pthread_mutex_lock(&cache->mutex);
+    FrameCacheEntry* owned = &cache->entries[entry - cache->entries];
+    if (--owned->refcount == 0) {
+        pthread_cond_broadcast(&cache->changed);
+    }
+    pthread_mutex_unlock(&cache->mutex);
+}
@@ -0,0 +1,201 @@
+#include "../include/aviation_system.h"
+
+// Live ingest ring: the capture thread publishes encoded frames into
+// LIVE_RING_SLOTS fixed-size slots, consumers read them by frame number.
+// Frame n lives in slot n % LIVE_RING_SLOTS until it is overwritten.
+// Every source has its own ring: source 0 keeps RING_SHM_NAME, source n
+// uses RING_SHM_NAME_n.
+
+static void frame_ring_name(int source_id, char* name, size_t size) {
+    if (source_id == 0) {
+        snprintf(name, size, "%s", RING_SHM_NAME);
+    } else {
+        snprintf(name, size, "%s_%d", RING_SHM_NAME, source_id);
+    }
+}
+
+FrameRing* init_frame_ring(int source_id) {
+    char name[64];
+    frame_ring_name(source_id, name, sizeof(name));
+
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0666);
+    if (fd == -1) {
+        perror("[FrameRing] shm_open failed");
+        return NULL;
+    }
+
+    if (ftruncate(fd, sizeof(FrameRing)) == -1) {
+        perror("[FrameRing] ftruncate failed");
+        close(fd);
+        return NULL;
+    }
+
+    FrameRing* ring = (FrameRing*)mmap(NULL, sizeof(FrameRing),
+                                       PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ring == MAP_FAILED) {
+        perror("[FrameRing] mmap failed");
+        return NULL;
+    }
+
+    pthread_mutexattr_t mutex_attr;
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&ring->mutex, &mutex_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+    pthread_cond_init(&ring->frame_published, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+
+    ring->head = 0;
+    ring->producer_done = false;
+    for (int i = 0; i < LIVE_RING_SLOTS; i++) {
+        ring->slots[i].frame_number = 0;
+        ring->slots[i].length = 0;
+    }
+
+    printf("[FrameRing] ✓ %d slots x %d KB in %s\n",
+           LIVE_RING_SLOTS, LIVE_SLOT_BYTES / 1024, name);
+    return ring;
+}
+
+void cleanup_frame_ring(FrameRing* ring, int source_id) {
+    if (ring) {
+        char name[64];
+        frame_ring_name(source_id, name, sizeof(name));
+        pthread_mutex_destroy(&ring->mutex);
+        pthread_cond_destroy(&ring->frame_published);
+        munmap(ring, sizeof(FrameRing));
+        shm_unlink(name);
+    }
+}
+
+bool frame_ring_publish(FrameRing* ring, int frame_number, const unsigned char* data,
+                        uint32_t length, const SensorData* sensor, const FrameTimes* times) {
+    if (length > LIVE_SLOT_BYTES) {
+        return false;
+    }
+
+    pthread_mutex_lock(&ring->mutex);
+    FrameRingSlot* slot = &ring->slots[frame_number % LIVE_RING_SLOTS];
+    memcpy(slot->data, data, length);
+    slot->length = length;
+    slot->sensor = *sensor;
+    slot->times = *times;
+    slot->frame_number = frame_number;
+    ring->head = frame_number;
+    pthread_cond_broadcast(&ring->frame_published);
+    pthread_mutex_unlock(&ring->mutex);
+    return true;
+}
+
+void frame_ring_close(FrameRing* ring) {
+    pthread_mutex_lock(&ring->mutex);
+    ring->producer_done = true;
+    pthread_cond_broadcast(&ring->frame_published);
+    pthread_mutex_unlock(&ring->mutex);
+}
+
+// Blocks until *frame_number is published, then copies it into buf
+// (buf may be NULL when only the sensor record is wanted; sensor and times
+// may be NULL too).
+// A reader that fell more than a ring behind is moved forward to the
+// oldest frame still held, and *frame_number is updated to match.
+// A frame the producer skipped (publish refused it) reads as missing:
+// *length 0 and zeroed sensor and times, never the slot's older frame.
+// Returns false when the producer is done or the system shuts down.
+bool frame_ring_read(FrameRing* ring, SharedMemory* shm, int* frame_number,
+                     unsigned char* buf, uint32_t* length, SensorData* sensor,
+                     FrameTimes* times) {
+    pthread_mutex_lock(&ring->mutex);
+
+    while (ring->head < *frame_number) {
+        if (ring->producer_done || !shm->system_active) {
+            pthread_mutex_unlock(&ring->mutex);
+            return false;
+        }
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += 200000000;  // Re-check shutdown every 200ms
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&ring->frame_published, &ring->mutex, &deadline);
+    }
+
+    int oldest = ring->head - LIVE_RING_SLOTS + 1;
+    if (*frame_number < oldest) {
+        *frame_number = oldest;
+    }
+
+    FrameRingSlot* slot = &ring->slots[*frame_number % LIVE_RING_SLOTS];
+    if (slot->frame_number != *frame_number) {
+        pthread_mutex_unlock(&ring->mutex);
+        if (length) *length = 0;
+        if (sensor) memset(sensor, 0, sizeof(*sensor));
+        if (times) memset(times, 0, sizeof(*times));
+        return true;
+    }
+    if (buf) {
+        memcpy(buf, slot->data, slot->length);
+        *length = slot->length;
+    }
+    if (sensor) {
+        *sensor = slot->sensor;
+    }
+    if (times) {
+        *times = slot->times;
+    }
+
+    pthread_mutex_unlock(&ring->mutex);
+    return true;
+}
+
+// Raw pixels of a feed's newest frames, next to its ring. They never leave
+// this process, so a plain heap buffer and mutex do.
+LiveRawFrames* live_raw_create(void) {
+    LiveRawFrames* raw = (LiveRawFrames*)calloc(1, sizeof(LiveRawFrames));
+    if (!raw) return NULL;
+    raw->pixels = (unsigned char*)malloc((size_t)LIVE_RAW_SLOTS * LIVE_RAW_FRAME_BYTES);
+    if (!raw->pixels) {
+        free(raw);
+        return NULL;
+    }
+    pthread_mutex_init(&raw->mutex, NULL);
+    return raw;
+}
+
+void live_raw_destroy(LiveRawFrames* raw) {
+    if (raw) {
+        pthread_mutex_destroy(&raw->mutex);
+        free(raw->pixels);
+        free(raw);
+    }
+}
+
+// Keeps frame_number's FRAME_WIDTH x FRAME_HEIGHT BGR pixels
+void live_raw_put(LiveRawFrames* raw, int frame_number, const unsigned char* pixels) {
+    int slot = frame_number % LIVE_RAW_SLOTS;
+    pthread_mutex_lock(&raw->mutex);
+    memcpy(raw->pixels + (size_t)slot * LIVE_RAW_FRAME_BYTES, pixels, LIVE_RAW_FRAME_BYTES);
+    raw->frame_number[slot] = frame_number;
+    pthread_mutex_unlock(&raw->mutex);
+}
+
+// Copies frame_number's pixels out; false once LIVE_RAW_SLOTS newer frames
+// replaced them (the caller falls back to the ring's JPEG)
+bool live_raw_get(LiveRawFrames* raw, int frame_number, unsigned char* pixels) {
+    int slot = frame_number % LIVE_RAW_SLOTS;
+    pthread_mutex_lock(&raw->mutex);
+    bool held = raw->frame_number[slot] == frame_number;
+    if (held) {
+        memcpy(pixels, raw->pixels + (size_t)slot * LIVE_RAW_FRAME_BYTES, LIVE_RAW_FRAME_BYTES);
+    }
+    pthread_mutex_unlock(&raw->mutex);
+    return held;
+}
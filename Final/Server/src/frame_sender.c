@@ -1,19 +1,126 @@
 #include "../include/aviation_system.h"
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
 
-#define UDP_FRAME_PORT 8889
-#define CHUNK_SIZE 1024
-#define MAX_CHUNKS 300
+// The stream is the server's one frame clock: a frame becomes the current
+// frame (for the sensor, detection, pipeline and dashboard threads) as it
+// goes out, and the threads waiting on the tick wake up
+static void publish_current_frame(SharedMemory* shm, int frame) {
+    pthread_mutex_lock(&shm->frame_mutex);
+    shm->current_frame = frame;
+    shm->total_frames_processed = frame;
+    frame_clock_tick(shm);
+    pthread_mutex_unlock(&shm->frame_mutex);
+}
 
+// One feed's stream: its own subscribers, sequence, repair history and
+// encoder, on the socket and token bucket all feeds share
 typedef struct {
-    int frame_num;
-    int chunk_id;
-    int total_chunks;
-    int chunk_size;
-    char data[CHUNK_SIZE];
-} FrameChunk;
+    VideoSource* source;            // NULL when playing the archive
+    FrameCache* cache;
+    StreamSender* sender;
+    AdaptiveEncoder* encoder;
+    LiveRawFrames* raw;
+    char label[32];                 // Log prefix
+    long joined;                    // Subscribers that had joined at the last frame
+    int last_alert;
+    int next;                       // Next frame to send
+    int sent;
+} FeedStream;
+
+// Re-encodes (when enabled) and sends one borrowed frame of the feed, then
+// returns the frame to the cache. Returns true once it went out.
+static bool send_feed_frame(SystemState* state, FeedStream* feed, int frame,
+                            const FrameCacheEntry* cached, unsigned char* raw_pixels,
+                            int source_rendition) {
+    SharedMemory* shm = state->shm;
+    StreamSender* sender = feed->sender;
+    AdaptiveEncoder* encoder = feed->encoder;
+    const unsigned char* jpeg = cached->data;
+    uint32_t filesize = cached->length;
+    if (filesize == 0) {
+        printf("%s Warning: Frame %d missing from cache\n", feed->label, frame);
+        frame_cache_release(feed->cache, cached);
+        return false;
+    }
+    FrameTimes times = cached->times;
+    SensorData sensor = cached->sensor;
+    if (times.capture_ns == 0) {
+        // Archived frame: it and its reading enter the pipeline now, as
+        // in the root tree
+        times.capture_ns = wire_realtime_ns();
+        times.encode_ns = times.capture_ns;
+        sensor.time_ns = times.capture_ns;
+    }
+    int level = 0;
+    int frame_width = FRAME_WIDTH;
+    int frame_height = FRAME_HEIGHT;
+    if (encoder) {
+        // Whoever just joined has no keyframe to apply deltas to
+        if (sender->subscribers.joined != feed->joined) {
+            adaptive_encoder_force_key(encoder);
+            feed->joined = sender->subscribers.joined;
+        }
+        level = ADAPTIVE_QUALITY
+                ? rate_controller_level(&sender->rate, FPS, wire_now_ns())
+                : ADAPT_START_LEVEL;
+        if (raw_pixels && live_raw_get(feed->raw, frame, raw_pixels)) {
+            adaptive_encoder_raw(encoder, frame, raw_pixels, FRAME_WIDTH, FRAME_HEIGHT);
+        } else if (source_rendition >= 0) {
+            uint32_t length;
+            const unsigned char* widest = frame_archive_rendition(
+                &feed->cache->archive, frame, source_rendition, &length);
+            if (widest) {
+                jpeg = widest;
+                filesize = length;
+            }
+        }
+        jpeg = adaptive_encoder_frame(encoder, frame, jpeg, filesize, &level, &filesize,
+                                      &frame_width, &frame_height);
+        if (!jpeg) {
+            printf("%s Warning: Frame %d cannot be re-encoded\n", feed->label, frame);
+            adaptive_encoder_force_key(encoder);
+            frame_cache_release(feed->cache, cached);
+            return false;
+        }
+        times.encode_ns = wire_realtime_ns();
+    }
+
+    // Sensor record first (it travels with the cached frame), so the
+    // client has it when the pixels complete
+    stream_send_meta(sender, frame, &sensor, &times, frame_width, frame_height);
+
+    // Each new detection on the feed is announced once; the dashboard keeps
+    // its own flag
+    DetectionResult detection;
+    bool alert = false;
+    pthread_mutex_lock(&shm->detection_mutex);
+    const DetectionResult* latest = feed->source ? &feed->source->detection
+                                                 : &shm->latest_detection;
+    if (latest->obstacle_detected && latest->frame_number != feed->last_alert) {
+        detection = *latest;
+        feed->last_alert = detection.frame_number;
+        alert = true;
+    }
+    pthread_mutex_unlock(&shm->detection_mutex);
+    if (alert) stream_send_alert(sender, &detection);
+
+    // All chunks of the frame go out in a few sendmmsg() batches, straight
+    // from the cached frame; the stream's token bucket spaces the batches
+    int datagrams = send_frame_chunks(sender, frame, jpeg, filesize);
+    frame_cache_release(feed->cache, cached);
+    if (datagrams < 0) {
+        printf("%s Warning: Frame %d not sent (%u bytes)\n",
+               feed->label, frame, filesize);
+        // It may have been the keyframe the next deltas refer to
+        if (encoder) adaptive_encoder_force_key(encoder);
+        return false;
+    }
+
+    if (encoder) rate_controller_frame_sent(&sender->rate, level, filesize);
+    if (feed->source) feed->source->last_streamed = frame;
+    printf("%s Sent frame %d (%d datagrams)\n", feed->label, frame, datagrams);
+    feed->sent++;
+    return true;
+}
 
 void* frame_sender_thread(void* arg) {
     SystemState* state = (SystemState*)arg;
@@ -25,75 +132,153 @@ void* frame_sender_thread(void* arg) {
     
     if (!shm->system_active) return NULL;
     
-    printf("[FrameSender] Starting UDP frame transmission on port %d\n", UDP_FRAME_PORT);
+    printf("[FrameSender] Starting UDP stream on port %d\n", UDP_PORT);
+    
+    // Chunks carry only used bytes, each filling one datagram on the path MTU
+    // of the first fixed target (subscribers joining later are assumed to sit
+    // behind a CHUNK_PATH_MTU link); every CHUNK_FEC_GROUP of them are
+    // followed by an XOR parity chunk
+    uint16_t chunk_size = chunk_payload_size(state->target_count > 0 ? &state->targets[0] : NULL);
+    printf("[FrameSender] Sending meta, alerts and frames to subscribers on port %d "
+           "(%u-byte chunks, FEC 1/%d)\n", UDP_SERVER_PORT, chunk_size, CHUNK_FEC_GROUP);
     
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-        perror("[FrameSender] Socket creation failed");
-        return NULL;
+    // Frames are borrowed from each feed's cache (fed by its live ring, or
+    // the archive for the one feed played without --live)
+    bool live = state->ring != NULL;
+    int feed_count = live ? state->source_count : 1;
+    
+    // Archive playback runs on the shared schedule; live frames go out as they
+    // arrive. Every message of every feed's stream draws on one token bucket.
+    StreamPacer pacer;
+    pacer_init(&pacer, "stream", live ? 0 : FPS, STREAM_SEND_RATE, STREAM_SEND_BURST);
+    StreamSender senders[MAX_SOURCES];
+    FeedStream feeds[MAX_SOURCES];
+    memset(feeds, 0, sizeof(feeds));
+    for (int i = 0; i < feed_count; i++) {
+        if (!stream_sender_init(&senders[i], state->udp_socket, chunk_size,
+                                CHUNK_FEC_GROUP, &pacer.bucket)) {
+            printf("[FrameSender] Error: Cannot allocate repair history\n");
+            for (int j = 0; j < i; j++) stream_sender_free(&senders[j]);
+            return NULL;
+        }
+        // Clients pick their feed by the source id every message carries
+        senders[i].source_id = (uint8_t)i;
+        FeedStream* feed = &feeds[i];
+        feed->sender = &senders[i];
+        feed->source = live ? &state->sources[i] : NULL;
+        feed->cache = live ? state->sources[i].cache : state->cache;
+        feed->raw = live ? state->sources[i].raw : NULL;
+        if (feed_count == 1) {
+            snprintf(feed->label, sizeof(feed->label), "[FrameSender]");
+        } else {
+            snprintf(feed->label, sizeof(feed->label), "[FrameSender %d]", i);
+        }
     }
     
-    struct sockaddr_in dest_addr;
-    dest_addr.sin_family = AF_INET;
-    dest_addr.sin_port = htons(UDP_FRAME_PORT);
-    dest_addr.sin_addr.s_addr = inet_addr(CLIENT_IP);
+    // Where the kernel supports it, runs of chunks go out as single buffers
+    // that it splits into datagrams itself
+    bool offload = CHUNK_SEGMENT_OFFLOAD;
+    for (int i = 0; i < feed_count && offload; i++) {
+        offload = stream_sender_enable_offload(&senders[i]);
+    }
+    if (offload) {
+        printf("[FrameSender] ✓ UDP segmentation offload enabled\n");
+    } else if (CHUNK_SEGMENT_OFFLOAD) {
+        printf("[FrameSender] UDP_SEGMENT not supported, sending one datagram per chunk\n");
+    }
     
-    printf("[FrameSender] Sending frames to %s:%d\n", CLIENT_IP, UDP_FRAME_PORT);
+    // --client and --multicast targets never expire and get every feed;
+    // clients that SUBSCRIBE to a feed come and go while the stream runs
+    for (int i = 0; i < feed_count; i++) {
+        for (int t = 0; t < state->target_count; t++) {
+            subscriber_join(&senders[i].subscribers, &state->targets[t], 0);
+        }
+        feeds[i].joined = senders[i].subscribers.joined;
+    }
     
-    // ★★★ SINGLE LOOP - FRAMES 1-240 ONLY ★★★
-    for (int frame = 1; frame <= TOTAL_FRAMES && shm->system_active; frame++) {
-        char filename[256];
-        snprintf(filename, sizeof(filename), "resources/frames/frame_%03d.jpg", frame);
-        
-        int fd = open(filename, O_RDONLY);
-        if (fd < 0) {
-            printf("[FrameSender] Warning: Cannot open %s\n", filename);
-            continue;
+    // Frames are re-encoded to fit what the receivers report getting through,
+    // and/or as tile deltas, from the best copy of each frame the server has:
+    // the captured pixels (live) or the archive's widest rendition, not the
+    // cached JPEG the dashboard shows. That one is only the fallback.
+    unsigned char* raw_pixels = NULL;
+    int source_rendition = -1;
+    if (ADAPTIVE_QUALITY || TILE_DELTA) {
+        for (int i = 0; i < feed_count; i++) {
+            feeds[i].encoder = adaptive_encoder_create(FRAME_WIDTH, FRAME_HEIGHT,
+                                                       TILE_DELTA);
         }
-        
-        struct stat st;
-        fstat(fd, &st);
-        int filesize = st.st_size;
-        
-        int total_chunks = (filesize + CHUNK_SIZE - 1) / CHUNK_SIZE;
-        if (total_chunks > MAX_CHUNKS) {
-            printf("[FrameSender] Warning: Frame %d too large, skipping\n", frame);
-            close(fd);
-            continue;
+        if (feeds[0].raw) raw_pixels = malloc(LIVE_RAW_FRAME_BYTES);
+        if (!live) {
+            source_rendition = (int)state->cache->archive.header->rendition_count - 1;
         }
-        
-        char buffer[CHUNK_SIZE];
-        int chunk_id = 0;
-        int bytes_read;
-        
-        while ((bytes_read = read(fd, buffer, CHUNK_SIZE)) > 0 && chunk_id < total_chunks) {
-            FrameChunk chunk;
-            chunk.frame_num = frame;
-            chunk.chunk_id = chunk_id;
-            chunk.total_chunks = total_chunks;
-            chunk.chunk_size = bytes_read;
-            memcpy(chunk.data, buffer, bytes_read);
-            
-            sendto(sock, &chunk, sizeof(FrameChunk), 0,
-                   (struct sockaddr*)&dest_addr, sizeof(dest_addr));
-            
-            chunk_id++;
-            usleep(1000);
+        printf("[FrameSender] ✓ Re-encoding %s (%s%s)\n",
+               raw_pixels ? "captured frames" : live ? "cached frames" : "widest rendition",
+               ADAPTIVE_QUALITY ? "adaptive quality" : "fixed quality",
+               TILE_DELTA ? ", tile deltas" : "");
+    }
+    
+    // ★★★ SINGLE LOOP - FRAMES 1-240 ONLY (unbounded in live mode) ★★★
+    // The primary feed is the frame clock; each tick the other feeds send
+    // whatever they captured meanwhile
+    for (int frame = 1; (live || frame <= TOTAL_FRAMES) && shm->system_active; frame++) {
+        // NACKs for earlier frames are answered while waiting for this one to
+        // be due (live mode: once per frame, before blocking on the cache)
+        long long wait;
+        do {
+            wait = pacer_ns_until_frame(&pacer, frame);
+            serve_stream_requests(senders, feed_count, wait);
+        } while (wait > 0 && shm->system_active);
+        uint64_t now = wire_now_ns();
+        for (int i = 0; i < feed_count; i++) {
+            subscriber_expire(&senders[i].subscribers, now);
         }
         
-        close(fd);
-        printf("[FrameSender] Sent frame %d (%d chunks)\n", frame, total_chunks);
+        const FrameCacheEntry* cached = frame_cache_borrow(feeds[0].cache, &frame);
+        if (!cached) break;
+        publish_current_frame(shm, frame);
+        bool sent = send_feed_frame(state, &feeds[0], frame, cached, raw_pixels,
+                                    source_rendition);
+        if (sent) pacer_frame_sent(&pacer, frame);
         
-        usleep(125000);  // 8 FPS delay
+        for (int i = 1; i < feed_count; i++) {
+            FeedStream* feed = &feeds[i];
+            if (feed->next == 0) feed->next = 1;
+            while (feed->next <= frame_cache_newest(feed->cache) && shm->system_active) {
+                cached = frame_cache_borrow(feed->cache, &feed->next);
+                if (!cached) break;
+                send_feed_frame(state, feed, feed->next, cached, raw_pixels, -1);
+                feed->next++;
+            }
+        }
     }
     // ★★★ LOOP ENDS HERE - NEVER RESTART ★★★
     
+    // Keep answering NACKs until the last frame is past its repair deadline
+    uint64_t linger_until = wire_now_ns() + WIRE_REPAIR_DEADLINE_MS * 1000000ULL;
+    for (uint64_t now = wire_now_ns(); now < linger_until && shm->system_active;
+         now = wire_now_ns()) {
+        serve_stream_requests(senders, feed_count, (long long)(linger_until - now));
+    }
+    
     printf("[FrameSender] ═══════════════════════════════════\n");
-    printf("[FrameSender] All %d frames sent - STOPPED\n", TOTAL_FRAMES);
+    for (int i = 0; i < feed_count; i++) {
+        FeedStream* feed = &feeds[i];
+        printf("%s All %d frames sent - STOPPED (%ld meta, %ld alerts)\n",
+               feed->label, feed->sent, senders[i].meta_sent, senders[i].alerts_sent);
+        print_chunk_send_stats(feed->label, &senders[i].stats);
+        print_repair_stats(feed->label, &senders[i].repairs);
+        print_subscriber_stats(feed->label, &senders[i].subscribers);
+        if (feed->encoder) {
+            if (ADAPTIVE_QUALITY) print_rate_stats(feed->label, &senders[i].rate);
+            print_adaptive_stats(feed->label, feed->encoder);
+            adaptive_encoder_destroy(feed->encoder);
+        }
+        stream_sender_free(&senders[i]);
+    }
+    free(raw_pixels);
+    pacer_report(&pacer);
     printf("[FrameSender] ═══════════════════════════════════\n");
     
-    close(sock);
-    
     // Sleep forever after completion
     while (shm->system_active) {
         sleep(3600);
@@ -101,4 +286,3 @@ void* frame_sender_thread(void* arg) {
     
     return NULL;
 }
-
@@ -1,10 +1,104 @@
 #include "../include/aviation_system.h"
 
-int main() {
+static void print_usage(const char* prog) {
+    printf("Usage: %s [--live [video|synthetic]] [--sources K] [--source PATH]...\n", prog);
+    printf("          [--capture-workers N] [--client IP[:PORT]]... [--multicast GROUP[:PORT]]\n");
+    printf("          [--bench-sources] [--bench-chunks] [--bench-fec] [--bench-fanout] [--bench-gso]\n");
+    printf("          [--bench-tiles]\n");
+    printf("  --live video         Decode %s straight into the live frame ring\n", VIDEO_PATH);
+    printf("  --live synthetic     Feed the live frame ring from a generated test pattern\n");
+    printf("  --sources K          Ingest K feeds at once (1-%d), one ring per feed\n", MAX_SOURCES);
+    printf("  --source PATH        Video file for the next feed (repeatable, implies --live)\n");
+    printf("  --capture-workers N  Capture pool size (default: one per core, <= K)\n");
+    printf("  --client IP[:PORT]   Always stream to this client (repeatable; default port %d)\n",
+           UDP_PORT);
+    printf("  --multicast GROUP[:PORT]  Stream to a multicast group (TTL %d)\n", MULTICAST_TTL);
+    printf("  (clients may also SUBSCRIBE to UDP port %d at any time)\n", UDP_SERVER_PORT);
+    printf("  --bench-sources      Measure aggregate ingest fps for 1, 2, 4 ... %d feeds\n",
+           MAX_SOURCES);
+    printf("  --bench-chunks       Compare per-chunk sendto() with batched sendmmsg()\n");
+    printf("  --bench-fec          Frame completion vs FEC/NACK overhead under injected loss\n");
+    printf("  --bench-fanout       Per-subscriber sends vs encode-once fan-out to 1-100 clients\n");
+    printf("  --bench-gso          CPU per frame with and without UDP_SEGMENT / UDP_GRO\n");
+    printf("  --bench-tiles        Bytes per frame, whole JPEGs vs tile deltas, on the archived clip\n");
+}
+
+int main(int argc, char* argv[]) {
+    bool live = false;
+    bool bench_sources = false;
+    int live_source = LIVE_SOURCE_VIDEO;
+    bool source_given = false;
+    int source_count = 0;
+    int capture_workers = 0;
+    const char* source_paths[MAX_SOURCES];
+    int path_count = 0;
+    struct sockaddr_in targets[MAX_STREAM_TARGETS];
+    int target_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--live") == 0) {
+            live = true;
+            if (i + 1 < argc && strcmp(argv[i + 1], "synthetic") == 0) {
+                live_source = LIVE_SOURCE_SYNTHETIC;
+                source_given = true;
+                i++;
+            } else if (i + 1 < argc && strcmp(argv[i + 1], "video") == 0) {
+                source_given = true;
+                i++;
+            }
+        } else if (strcmp(argv[i], "--sources") == 0 && i + 1 < argc) {
+            source_count = atoi(argv[++i]);
+            if (source_count < 1 || source_count > MAX_SOURCES) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--source") == 0 && i + 1 < argc &&
+                   path_count < MAX_SOURCES) {
+            live = true;
+            source_paths[path_count++] = argv[++i];
+        } else if (strcmp(argv[i], "--capture-workers") == 0 && i + 1 < argc) {
+            capture_workers = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "--client") == 0 || strcmp(argv[i], "--multicast") == 0) &&
+                   i + 1 < argc) {
+            bool multicast = strcmp(argv[i], "--multicast") == 0;
+            struct sockaddr_in* target = &targets[target_count];
+            if (target_count == MAX_STREAM_TARGETS ||
+                !parse_stream_target(argv[++i], UDP_PORT, target) ||
+                multicast != IN_MULTICAST(ntohl(target->sin_addr.s_addr))) {
+                print_usage(argv[0]);
+                return 1;
+            }
+            target_count++;
+        } else if (strcmp(argv[i], "--bench-sources") == 0) {
+            bench_sources = true;
+        } else if (strcmp(argv[i], "--bench-chunks") == 0) {
+            benchmark_chunk_send();
+            return 0;
+        } else if (strcmp(argv[i], "--bench-fec") == 0) {
+            benchmark_fec();
+            return 0;
+        } else if (strcmp(argv[i], "--bench-fanout") == 0) {
+            benchmark_fanout();
+            return 0;
+        } else if (strcmp(argv[i], "--bench-gso") == 0) {
+            benchmark_segmentation();
+            return 0;
+        } else if (strcmp(argv[i], "--bench-tiles") == 0) {
+            benchmark_tile_delta();
+            return 0;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (source_count < path_count) source_count = path_count;
+    if (source_count < 1) source_count = 1;
+
     printf("\n");
     printf("***********************************************************\n");
     printf(" AVIATION SERVER - COMPLETE STREAMING MODE \n");
-    printf(" UDP: 8888 (meta) | 8889 (frames) | 9000 (video) \n");
+    printf(" UDP: 8888 (meta + alerts + frames, one stream) \n");
+    printf(" UDP: 8887 (subscriptions and NACKs from clients) \n");
     printf(" WEB: 8080 (dashboard) - http://localhost:8080 \n");
     printf("***********************************************************\n");
     printf("\n");
@@ -16,57 +110,151 @@ int main() {
     }
 
     init_signal_handlers(shm);
+
+    if (bench_sources) {
+        // Synthetic feeds unless a video source was asked for explicitly
+        int kind = source_given ? live_source : LIVE_SOURCE_SYNTHETIC;
+        benchmark_multi_source(shm, kind, capture_workers);
+        cleanup_shared_memory(shm);
+        return 0;
+    }
+
     initialize_sensor_data(shm);
 
-    printf("[Server] Checking for pre-extracted frames...\n");
-    struct stat st = {0};
-    char first_frame[256];
-    snprintf(first_frame, sizeof(first_frame), "%s/frame_001.jpg", FRAMES_DIR);
+    SystemState state;
+    memset(&state, 0, sizeof(state));
+    state.shm = shm;
+    memcpy(state.targets, targets, sizeof(targets));
+    state.target_count = target_count;
     
-    if (stat(first_frame, &st) == 0) {
-        printf("[Server] ✓ Found existing frames, skipping extraction\n");
-        printf("[Server] Using frames from: %s\n", FRAMES_DIR);
+    if (live) {
+        // Frames are produced while running; consumers block on the rings
+        printf("[Server] Live ingest mode - %d feed%s, no pre-extracted frames needed\n",
+               source_count, source_count == 1 ? "" : "s");
+        for (int i = 0; i < source_count; i++) {
+            VideoSource* source = &state.sources[i];
+            source->id = i;
+            source->kind = i < path_count ? LIVE_SOURCE_VIDEO : live_source;
+            snprintf(source->path, sizeof(source->path), "%s",
+                     i < path_count ? source_paths[i] : VIDEO_PATH);
+            source->ring = init_frame_ring(i);
+            state.source_count = i + 1;
+            if (!source->ring) {
+                fprintf(stderr, "[ERROR] Failed to create live frame ring for source %d\n", i);
+                for (int j = 0; j < i; j++) {
+                    cleanup_frame_ring(state.sources[j].ring, j);
+                    live_raw_destroy(state.sources[j].raw);
+                }
+                cleanup_shared_memory(shm);
+                return 1;
+            }
+            // Each feed's stream encoder reads its raw copy; without it the
+            // encoder decodes the ring's JPEG instead
+            if (ADAPTIVE_QUALITY || TILE_DELTA) source->raw = live_raw_create();
+        }
+        state.ring = state.sources[0].ring;
+        shm->live_mode = true;
         shm->frames_extracted = true;
     } else {
-        fprintf(stderr, "[ERROR] No frames found in %s\n", FRAMES_DIR);
-        fprintf(stderr, "[SOLUTION] Run aviation_monitor first to extract frames:\n");
-        fprintf(stderr, "  1. cd ../monitor && ./aviation_monitor\n");
-        fprintf(stderr, "  2. Wait for extraction to complete\n");
-        fprintf(stderr, "  3. cd ../server && ln -s ../monitor/resources/frames resources/frames\n");
-        fprintf(stderr, "  4. ./aviation_server\n");
-        cleanup_shared_memory(shm);
-        return 1;
+        printf("[Server] Checking for pre-extracted frames...\n");
+        FrameArchive archive;
+        
+        if (frame_archive_open(&archive, FRAME_ARCHIVE_PATH)) {
+            printf("[Server] ✓ Found frame archive, skipping extraction\n");
+            printf("[Server] Using %u frames from: %s\n",
+                   archive.header->frame_count, FRAME_ARCHIVE_PATH);
+            frame_archive_close(&archive);
+            shm->frames_extracted = true;
+        } else {
+            fprintf(stderr, "[ERROR] No frame archive found at %s\n", FRAME_ARCHIVE_PATH);
+            fprintf(stderr, "[SOLUTION] Run aviation_monitor first to extract frames:\n");
+            fprintf(stderr, "  1. cd ../monitor && ./aviation_monitor\n");
+            fprintf(stderr, "  2. Wait for extraction to complete\n");
+            fprintf(stderr, "  3. cd ../server && ln -s ../monitor/resources/frames resources/frames\n");
+            fprintf(stderr, "  4. ./aviation_server  (or ./aviation_server --live)\n");
+            cleanup_shared_memory(shm);
+            return 1;
+        }
     }
 
     int udp_socket = init_udp_socket();
     if (udp_socket < 0) {
         fprintf(stderr, "[ERROR] UDP socket creation failed\n");
+        for (int i = 0; i < state.source_count; i++) {
+            cleanup_frame_ring(state.sources[i].ring, i);
+            live_raw_destroy(state.sources[i].raw);
+        }
         cleanup_shared_memory(shm);
         return 1;
     }
-
-    SystemState state;
-    state.shm = shm;
     state.udp_socket = udp_socket;
 
-    printf("[Server] Starting 8 threads (7 UDP + 1 Web)...\n\n");
+    // The frame sender and dashboard borrow each feed's frames from its cache
+    bool cached = true;
+    if (live) {
+        for (int i = 0; i < state.source_count; i++) {
+            state.sources[i].cache = frame_cache_create(shm, state.sources[i].ring);
+            if (!state.sources[i].cache) cached = false;
+        }
+        state.cache = state.sources[0].cache;
+    } else {
+        state.cache = frame_cache_create(shm, NULL);
+        cached = state.cache != NULL;
+    }
+    if (!cached) {
+        fprintf(stderr, "[ERROR] Failed to create frame cache\n");
+        close(udp_socket);
+        for (int i = 0; i < state.source_count; i++) {
+            frame_cache_destroy(state.sources[i].cache);
+            cleanup_frame_ring(state.sources[i].ring, i);
+            live_raw_destroy(state.sources[i].raw);
+        }
+        cleanup_shared_memory(shm);
+        return 1;
+    }
 
-    pthread_t threads[8];
+    printf("[Server] Starting 6 threads (5 UDP + 1 Web)%s...\n\n",
+           live ? " + capture pool" : "");
+
+    // The frame sender also advances the current frame the others follow
+    pthread_t threads[6];
     pthread_create(&threads[0], NULL, sensor_data_thread, shm);
-    pthread_create(&threads[1], NULL, video_acquisition_thread, &state);
+    pthread_create(&threads[1], NULL, frame_sender_thread, &state);
     pthread_create(&threads[2], NULL, detection_thread, shm);
     pthread_create(&threads[3], NULL, processing_pipeline_thread, shm);
     pthread_create(&threads[4], NULL, watchdog_thread, shm);
-    pthread_create(&threads[5], NULL, frame_sender_thread, &state);
-    pthread_create(&threads[6], NULL, video_streamer_thread, &state);
-    pthread_create(&threads[7], NULL, web_server_thread, shm);
+    pthread_create(&threads[5], NULL, web_server_thread, &state);
+
+    // One pool of capture workers serves every feed
+    CapturePool* pool = NULL;
+    if (live) {
+        pool = capture_pool_start(&state, capture_workers, true);
+        printf("[Server] ✓ Capture pool: %d worker%s for %d feed%s\n",
+               capture_pool_workers(pool), capture_pool_workers(pool) == 1 ? "" : "s",
+               state.source_count, state.source_count == 1 ? "" : "s");
+    }
 
     // Wait for all threads
-    for (int i = 0; i < 8; i++) {
+    for (int i = 0; i < 6; i++) {
         pthread_join(threads[i], NULL);
     }
 
+    if (pool) {
+        capture_pool_stop(pool);
+        capture_pool_join(pool);
+        for (int i = 0; i < state.source_count; i++) {
+            printf("[Server] Source %d: %d frames, %d detections\n", i,
+                   state.sources[i].frames_published, state.sources[i].detections);
+        }
+    }
+
+    if (!live) frame_cache_destroy(state.cache);
     close(udp_socket);
+    for (int i = 0; i < state.source_count; i++) {
+        frame_cache_destroy(state.sources[i].cache);
+        cleanup_frame_ring(state.sources[i].ring, i);
+        live_raw_destroy(state.sources[i].raw);
+    }
     cleanup_shared_memory(shm);
 
     printf("\n[Server] Shutdown complete\n");
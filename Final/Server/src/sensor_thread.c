@@ -17,24 +17,30 @@ void* sensor_data_thread(void* arg) {
     printf("[SensorThread] ✓ Frames ready, starting frame progression\n");
     
     int last_frame = 0;
+    TickFollower clock;
+    tick_follower_init(&clock, "sensor");
     
-    // Monitor frames but DON'T set them - video_thread.c does that
+    // Monitor frames but DON'T set them - frame_sender.c does that; each
+    // tick of its frame clock wakes this thread
     while (shm->system_active) {
-        pthread_mutex_lock(&shm->frame_mutex);
-        int current_frame = shm->current_frame;
-        pthread_mutex_unlock(&shm->frame_mutex);
+        int current_frame = frame_clock_wait(shm, &clock, FRAME_TICK_TIMEOUT_MS);
         
-        // Exit when we reach frame 240
-        if (current_frame >= TOTAL_FRAMES) {
+        // Exit when we reach frame 240 (live sessions have no last frame)
+        if (!shm->live_mode && current_frame >= TOTAL_FRAMES) {
             printf("[SensorThread] Reached frame %d - STOPPING\n", TOTAL_FRAMES);
             break;
         }
         
         // Update sensor data for current frame
-        if (current_frame != last_frame && current_frame > 0 && current_frame <= TOTAL_FRAMES) {
+        if (current_frame != last_frame && current_frame > 0) {
             pthread_mutex_lock(&shm->sensor_mutex);
-            shm->current_sensor = shm->frame_sensors[current_frame - 1];
+            if (current_frame <= TOTAL_FRAMES) {
+                shm->current_sensor = shm->frame_sensors[current_frame - 1];
+            } else {
+                generate_sensor_reading(current_frame - 1, &shm->current_sensor);
+            }
             shm->current_sensor.frame_number = current_frame;
+            shm->current_sensor.time_ns = wire_realtime_ns();
             pthread_mutex_unlock(&shm->sensor_mutex);
             
             if (current_frame % 30 == 0) {
@@ -44,9 +50,8 @@ void* sensor_data_thread(void* arg) {
             
             last_frame = current_frame;
         }
-        
-        usleep(50000);  // Check every 50ms
     }
+    tick_follower_report(&clock);
     
     // Sleep forever after completion
     while (shm->system_active) {
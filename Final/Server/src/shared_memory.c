@@ -44,6 +44,8 @@ SharedMemory* init_shared_memory() {
     pthread_condattr_init(&cond_attr);
     pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
     pthread_cond_init(&shm->ui_update_cond, &cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);    // Frame clock deadlines
+    pthread_cond_init(&shm->frame_tick_cond, &cond_attr);
     pthread_condattr_destroy(&cond_attr);
 
     sem_unlink(SEM_FRAME_READY);
@@ -59,7 +61,9 @@ SharedMemory* init_shared_memory() {
 
     shm->system_active = true;
     shm->frames_extracted = false;
+    shm->live_mode = false;
     shm->current_frame = 0;
+    shm->frame_tick_ns = 0;
     shm->total_frames_processed = 0;
     shm->frame_ready_for_processing = false;
     shm->processing_complete = false;
@@ -76,25 +80,32 @@ SharedMemory* init_shared_memory() {
     return shm;
 }
 
+// Simulated sensor reading for 0-based frame index i. Also used by live
+// ingest, where sessions run past TOTAL_FRAMES.
+void generate_sensor_reading(int i, SensorData* sensor) {
+    sensor->frame_number = i + 1;
+    
+    // Simulate realistic altitude changes (1000m to 2000m)
+    sensor->altitude = 1000.0 + (i * 5.2);
+    
+    // Simulate realistic speed changes (250 km/h to 450 km/h)
+    sensor->speed = 250.0 + (i * 1.04);
+    
+    // Simulate GPS coordinates changing (simulated flight path)
+    sensor->latitude = 28.5000 + (i * 0.0001);
+    sensor->longitude = 77.2000 + (i * 0.0001);
+    
+    sensor->timestamp = time(NULL);
+    sensor->time_ns = wire_realtime_ns();
+    sensor->is_valid = true;
+}
+
 // ✅ NEW FUNCTION: Initialize sensor data for all frames
 void initialize_sensor_data(SharedMemory* shm) {
     printf("[SharedMemory] Initializing sensor data for %d frames...\n", TOTAL_FRAMES);
     
     for (int i = 0; i < TOTAL_FRAMES; i++) {
-        shm->frame_sensors[i].frame_number = i + 1;
-        
-        // Simulate realistic altitude changes (1000m to 2000m)
-        shm->frame_sensors[i].altitude = 1000.0 + (i * 5.2);
-        
-        // Simulate realistic speed changes (250 km/h to 450 km/h)
-        shm->frame_sensors[i].speed = 250.0 + (i * 1.04);
-        
-        // Simulate GPS coordinates changing (simulated flight path)
-        shm->frame_sensors[i].latitude = 28.5000 + (i * 0.0001);
-        shm->frame_sensors[i].longitude = 77.2000 + (i * 0.0001);
-        
-        shm->frame_sensors[i].timestamp = time(NULL);
-        shm->frame_sensors[i].is_valid = true;
+        generate_sensor_reading(i, &shm->frame_sensors[i]);
     }
     
     printf("[SharedMemory] ✓ Sensor data initialized for all %d frames\n", TOTAL_FRAMES);
@@ -114,6 +125,7 @@ void cleanup_shared_memory(SharedMemory* shm) {
         pthread_mutex_destroy(&shm->ui_mutex);
         pthread_barrier_destroy(&shm->processing_barrier);
         pthread_cond_destroy(&shm->ui_update_cond);
+        pthread_cond_destroy(&shm->frame_tick_cond);
 
         sem_close(shm->sem_frame_ready);
         sem_close(shm->sem_processing_done);
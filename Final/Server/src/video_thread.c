@@ -1,66 +1,343 @@
 #include "../include/aviation_system.h"
 #include <opencv2/opencv.hpp>
 
+#include <time.h>
+
 using namespace cv;
 
-extern "C" void* video_acquisition_thread(void* arg) {
-    SystemState* state = (SystemState*)arg;
-    SharedMemory* shm = state->shm;
+static void advance_deadline(struct timespec* deadline, long nanoseconds) {
+    deadline->tv_nsec += nanoseconds;
+    while (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_nsec -= 1000000000L;
+        deadline->tv_sec++;
+    }
+}
+
+static double seconds_since(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
 
-    printf("[VideoThread] Starting - ONE-TIME playback mode\n");
+// Test pattern for --live synthetic: moving block plus camera and frame counter
+static void render_synthetic_frame(Mat& frame, int source_id, int frame_number) {
+    frame = Mat(FRAME_HEIGHT, FRAME_WIDTH, CV_8UC3, Scalar(90, 60 + 20 * source_id, 30));
+    int x = (frame_number * 4) % (FRAME_WIDTH - 40);
+    rectangle(frame, Rect(x, FRAME_HEIGHT / 2 - 20, 40, 40), Scalar(0, 200, 255), -1);
+    char label[32];
+    snprintf(label, sizeof(label), "CAM%d LIVE %d", source_id, frame_number);
+    putText(frame, label, Point(10, 30), FONT_HERSHEY_SIMPLEX, 0.8, Scalar(255, 255, 255), 2);
+}
 
-    while (!shm->frames_extracted && shm->system_active) {
-        usleep(100000);
-    }
-    
-    if (!shm->frames_extracted) {
-        printf("[VideoThread] ERROR: No frames available\n");
-        return NULL;
-    }
+// Decode state of one source. Only the worker that has claimed the feed
+// touches it, so VideoCapture never sees two threads at once.
+typedef struct {
+    VideoSource* source;
+    VideoCapture capture;
+    std::vector<uchar> jpeg;
+    int frame_skip;
+    int decoded;
+    struct timespec start;
+    struct timespec deadline;       // When the next frame is due
+    bool busy;                      // Claimed by a worker
+    bool done;                      // Source ended or failed
+} SourceFeed;
 
-    printf("[VideoThread] Transmitting frames 1-%d (NO LOOP)\n\n", TOTAL_FRAMES);
+// Workers repeatedly claim the free feed whose next frame is due first,
+// produce that one frame and hand the feed back, so W workers serve K feeds.
+struct CapturePool {
+    SystemState* state;
+    SourceFeed feeds[MAX_SOURCES];
+    int feed_count;
+    int active;                     // Feeds not yet done
+    bool paced;
+    bool stop;
+    pthread_t threads[MAX_SOURCES];
+    int worker_count;
+    pthread_mutex_t mutex;
+    pthread_cond_t feed_released;
+};
 
-    for (int i = 1; i <= TOTAL_FRAMES; i++) {
-        if (!shm->system_active) break;
-        
-        pthread_mutex_lock(&shm->frame_mutex);
-        shm->current_frame = i;
-        shm->total_frames_processed = i;
-        pthread_mutex_unlock(&shm->frame_mutex);
+static bool open_feed(SourceFeed* feed) {
+    VideoSource* source = feed->source;
+    feed->frame_skip = 1;
+    feed->decoded = 0;
+    if (source->kind == LIVE_SOURCE_SYNTHETIC) return true;
 
-        VideoPacket packet;
-        packet.frame_id = i;
-        snprintf(packet.frame_path, sizeof(packet.frame_path), 
-                 "%s/frame_%03d.ppm", FRAMES_DIR, i);
-        packet.frame_width = 320;
-        packet.frame_height = 240;
+    if (!feed->capture.open(source->path)) {
+        fprintf(stderr, "[LiveCapture] ERROR: Source %d cannot open %s\n",
+                source->id, source->path);
+        return false;
+    }
+    feed->frame_skip = (int)(feed->capture.get(CAP_PROP_FPS) / FPS);
+    if (feed->frame_skip < 1) feed->frame_skip = 1;
+    return true;
+}
 
-        pthread_mutex_lock(&shm->sensor_mutex);
-        if (i - 1 < TOTAL_FRAMES) {
-            packet.sensor = shm->frame_sensors[i - 1];
+// Blocks until a feed is free; NULL once every feed is done or on shutdown
+static SourceFeed* claim_feed(CapturePool* pool) {
+    SharedMemory* shm = pool->state->shm;
+    pthread_mutex_lock(&pool->mutex);
+    while (!pool->stop && shm->system_active && pool->active > 0) {
+        SourceFeed* next = NULL;
+        for (int i = 0; i < pool->feed_count; i++) {
+            SourceFeed* feed = &pool->feeds[i];
+            if (feed->busy || feed->done) continue;
+            if (!next || feed->deadline.tv_sec < next->deadline.tv_sec ||
+                (feed->deadline.tv_sec == next->deadline.tv_sec &&
+                 feed->deadline.tv_nsec < next->deadline.tv_nsec)) {
+                next = feed;
+            }
         }
-        pthread_mutex_unlock(&shm->sensor_mutex);
+        if (next) {
+            next->busy = true;
+            pthread_mutex_unlock(&pool->mutex);
+            return next;
+        }
+
+        struct timespec timeout;
+        clock_gettime(CLOCK_REALTIME, &timeout);
+        advance_deadline(&timeout, 200000000L);  // Re-check shutdown every 200ms
+        pthread_cond_timedwait(&pool->feed_released, &pool->mutex, &timeout);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
 
-        send_video_packet_udp(state->udp_socket, &packet);
+static void release_feed(CapturePool* pool, SourceFeed* feed) {
+    pthread_mutex_lock(&pool->mutex);
+    feed->busy = false;
+    if (feed->done) {
+        pool->active--;
+    }
+    pthread_cond_broadcast(&pool->feed_released);
+    pthread_mutex_unlock(&pool->mutex);
+}
 
-        if (i % 10 == 0) {
-            printf("[VideoThread] %d/%d (%.1f%%)\n", i, TOTAL_FRAMES, (i*100.0)/TOTAL_FRAMES);
+// Scripted obstacle check, run per feed on the frame just captured. A hit
+// becomes the feed's latest detection, which its stream announces.
+static void detect_on_feed(SourceFeed* feed, SharedMemory* shm, const SensorData* sensor,
+                           bool verbose) {
+    VideoSource* source = feed->source;
+    int frame_number = source->frames_published;
+    if (frame_number == OBSTACLE_FRAME_1 || frame_number == OBSTACLE_FRAME_2) {
+        source->detections++;
+        pthread_mutex_lock(&shm->detection_mutex);
+        DetectionResult* detection = &source->detection;
+        detection->frame_number = frame_number;
+        detection->obstacle_detected = true;
+        snprintf(detection->detection_type, sizeof(detection->detection_type), "%s",
+                 frame_number == OBSTACLE_FRAME_1 ? "Aircraft - First Detection"
+                                                  : "Aircraft - Confirmed Detection");
+        detection->sensor_snapshot = *sensor;
+        pthread_mutex_unlock(&shm->detection_mutex);
+        if (verbose) {
+            printf("[Source %d] ⚠ Obstacle detected at frame %d (alt %.0fm, %.0fkm/h)\n",
+                   source->id, frame_number, sensor->altitude, sensor->speed);
         }
+    }
+}
+
+// Decode (or synthesize), encode, publish and check one frame of the feed.
+// Returns false when the feed has ended. The video source rewinds at end of
+// file so sessions can run past TOTAL_FRAMES.
+static bool capture_one_frame(SourceFeed* feed, SharedMemory* shm, bool verbose) {
+    VideoSource* source = feed->source;
+    if (LIVE_MAX_FRAMES != 0 && source->frames_published >= LIVE_MAX_FRAMES) return false;
 
-        usleep(125000);
+    FrameTimes times;
+    Mat frame;
+    if (source->kind == LIVE_SOURCE_SYNTHETIC) {
+        render_synthetic_frame(frame, source->id, source->frames_published + 1);
+    } else {
+        // Sequential decode; grab() skips frames off the FPS grid
+        do {
+            if (!feed->capture.grab()) {
+                feed->capture.set(CAP_PROP_POS_FRAMES, 0);
+                feed->decoded = 0;
+                if (!feed->capture.grab()) return false;
+            }
+        } while (feed->decoded++ % feed->frame_skip != 0);
+
+        Mat full;
+        if (!feed->capture.retrieve(full) || full.empty()) return false;
+        resize(full, frame, Size(FRAME_WIDTH, FRAME_HEIGHT));
     }
+    times.capture_ns = wire_realtime_ns();
 
-    printf("\n");
-    printf("════════════════════════════════════════\n");
-    printf("  ✓✓✓ COMPLETE - %d FRAMES SENT ✓✓✓\n", TOTAL_FRAMES);
-    printf("  Counter locked at: %d\n", TOTAL_FRAMES);
-    printf("  NO FURTHER UPDATES\n");
-    printf("════════════════════════════════════════\n\n");
+    int frame_number = source->frames_published + 1;
+    imencode(".jpg", frame, feed->jpeg);
+    times.encode_ns = wire_realtime_ns();
+
+    SensorData sensor;
+    generate_sensor_reading(frame_number - 1, &sensor);
+
+    // Before the ring, so the stream encoder finds the pixels when the frame
+    // reaches it and never has to decode the JPEG
+    if (source->raw && frame.isContinuous() && frame.type() == CV_8UC3 &&
+        frame.cols == FRAME_WIDTH && frame.rows == FRAME_HEIGHT) {
+        live_raw_put(source->raw, frame_number, frame.data);
+    }
+
+    if (!frame_ring_publish(source->ring, frame_number, feed->jpeg.data(),
+                            (uint32_t)feed->jpeg.size(), &sensor, &times)) {
+        printf("[LiveCapture] Warning: Source %d frame %d (%zu bytes) exceeds slot size\n",
+               source->id, frame_number, feed->jpeg.size());
+    }
+    source->frames_published = frame_number;
+    detect_on_feed(feed, shm, &sensor, verbose);
 
-    while (shm->system_active) {
-        sleep(3600);
+    if (frame_number == 1 && verbose) {
+        printf("[LiveCapture] ✓ Source %d: first frame published after %.1f ms\n",
+               source->id, seconds_since(&feed->start) * 1000.0);
     }
+    return true;
+}
 
+static void* capture_worker(void* arg) {
+    CapturePool* pool = (CapturePool*)arg;
+    SourceFeed* feed;
+
+    while ((feed = claim_feed(pool)) != NULL) {
+        // Absolute schedule so decode time does not stretch the frame period
+        if (pool->paced) {
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &feed->deadline, NULL);
+        }
+
+        // Unpaced pools never sleep but still advance the deadline, so the
+        // earliest-deadline pick keeps rotating through the feeds
+        if (!capture_one_frame(feed, pool->state->shm, pool->paced)) {
+            feed->done = true;
+            frame_ring_close(feed->source->ring);
+        } else {
+            advance_deadline(&feed->deadline, 1000000000L / FPS);
+        }
+        release_feed(pool, feed);
+    }
     return NULL;
 }
 
+extern "C" CapturePool* capture_pool_start(SystemState* state, int workers, bool paced) {
+    CapturePool* pool = new CapturePool;
+    pool->state = state;
+    pool->feed_count = state->source_count;
+    pool->active = 0;
+    pool->paced = paced;
+    pool->stop = false;
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->feed_released, NULL);
+
+    for (int i = 0; i < pool->feed_count; i++) {
+        SourceFeed* feed = &pool->feeds[i];
+        feed->source = &state->sources[i];
+        feed->busy = false;
+        feed->done = !open_feed(feed);
+        clock_gettime(CLOCK_MONOTONIC, &feed->start);
+        feed->deadline = feed->start;
+        if (feed->done) {
+            frame_ring_close(feed->source->ring);
+        } else {
+            pool->active++;
+        }
+    }
+
+    if (workers <= 0) workers = CAPTURE_POOL_WORKERS;
+    if (workers <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = cores > 0 ? (int)cores : 1;
+    }
+    if (workers > pool->feed_count) workers = pool->feed_count;
+    if (workers < 1) workers = 1;
+
+    pool->worker_count = workers;
+    for (int i = 0; i < workers; i++) {
+        pthread_create(&pool->threads[i], NULL, capture_worker, pool);
+    }
+    return pool;
+}
+
+extern "C" int capture_pool_workers(const CapturePool* pool) {
+    return pool->worker_count;
+}
+
+extern "C" void capture_pool_stop(CapturePool* pool) {
+    pthread_mutex_lock(&pool->mutex);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->feed_released);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+// Joins the workers, closes every ring so readers unblock, frees the pool
+extern "C" void capture_pool_join(CapturePool* pool) {
+    for (int i = 0; i < pool->worker_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    for (int i = 0; i < pool->feed_count; i++) {
+        pool->feeds[i].capture.release();
+        frame_ring_close(pool->feeds[i].source->ring);
+    }
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->feed_released);
+    delete pool;
+}
+
+// --bench-sources: K = 1, 2, 4 ... MAX_SOURCES feeds run unpaced for
+// BENCH_SOURCE_SECONDS each; reports aggregate and per-feed frame rates
+extern "C" void benchmark_multi_source(SharedMemory* shm, int kind, int workers) {
+    printf("\n[Benchmark] Multi-source ingest, %s feeds, %ds per run\n",
+           kind == LIVE_SOURCE_SYNTHETIC ? "synthetic" : VIDEO_PATH, BENCH_SOURCE_SECONDS);
+
+    int counts[8];
+    int runs = 0;
+    double aggregate[8];
+    int pool_workers[8];
+
+    for (int k = 1; k <= MAX_SOURCES && runs < 8; k *= 2) {
+        SystemState state;
+        memset(&state, 0, sizeof(state));
+        state.shm = shm;
+        state.source_count = k;
+
+        bool ok = true;
+        for (int i = 0; i < k; i++) {
+            VideoSource* source = &state.sources[i];
+            source->id = i;
+            source->kind = kind;
+            snprintf(source->path, sizeof(source->path), "%s", VIDEO_PATH);
+            source->ring = init_frame_ring(i);
+            if (!source->ring) ok = false;
+        }
+
+        if (ok) {
+            struct timespec start;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            CapturePool* pool = capture_pool_start(&state, workers, false);
+            pool_workers[runs] = capture_pool_workers(pool);
+            sleep(BENCH_SOURCE_SECONDS);
+            capture_pool_stop(pool);
+            capture_pool_join(pool);
+            double wall = seconds_since(&start);
+
+            int frames = 0;
+            for (int i = 0; i < k; i++) {
+                frames += state.sources[i].frames_published;
+            }
+            counts[runs] = k;
+            aggregate[runs] = wall > 0 ? frames / wall : 0.0;
+            runs++;
+        }
+
+        for (int i = 0; i < k; i++) {
+            cleanup_frame_ring(state.sources[i].ring, i);
+        }
+        if (!ok) break;
+    }
+
+    printf("\n[Benchmark] Sources | Workers | Aggregate fps | Per-source fps | Realtime feeds @%d\n",
+           FPS);
+    for (int r = 0; r < runs; r++) {
+        printf("[Benchmark] %7d | %7d | %13.1f | %14.1f | %d\n", counts[r], pool_workers[r],
+               aggregate[r], aggregate[r] / counts[r], (int)(aggregate[r] / FPS));
+    }
+    printf("\n");
+}
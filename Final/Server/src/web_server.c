@@ -2,10 +2,12 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <sys/uio.h>
+#include <errno.h>
 
 #define WEB_PORT 8080
 #define BUFFER_SIZE 4096
-#define HTML_BUFFER_SIZE 16384
+#define HTML_BUFFER_SIZE 24576   // Room for a frame card per feed
 
 typedef struct {
     int entry_frame;
@@ -18,7 +20,8 @@ typedef struct {
     SensorData exit_sensor;
 } ObstacleMetrics;
 
-void generate_dashboard_html(SharedMemory* shm, char* html_buffer, size_t buffer_size) {
+void generate_dashboard_html(SystemState* state, char* html_buffer, size_t buffer_size) {
+    SharedMemory* shm = state->shm;
     pthread_mutex_lock(&shm->sensor_mutex);
     SensorData current = shm->current_sensor;
     pthread_mutex_unlock(&shm->sensor_mutex);
@@ -55,7 +58,7 @@ void generate_dashboard_html(SharedMemory* shm, char* html_buffer, size_t buffer
     const char* status_color = has_detection ? "#dc2626" : "#10b981";
     const char* status_text = has_detection ? "ALERT" : "NORMAL";
     
-    bool playback_complete = (current_frame >= TOTAL_FRAMES);
+    bool playback_complete = !shm->live_mode && (current_frame >= TOTAL_FRAMES);
     const char* completion_status = "";
     if (playback_complete) {
         status_text = "CLEAR";
@@ -232,6 +235,33 @@ void generate_dashboard_html(SharedMemory* shm, char* html_buffer, size_t buffer
     );
     strncat(html_buffer, temp_buffer, buffer_size - strlen(html_buffer) - 1);
     
+    // Current frame, served from the shared frame cache by /frame.jpg; with
+    // several live feeds, the frame each feed's stream sent last
+    if (current_frame > 0 && state->source_count <= 1) {
+        snprintf(temp_buffer, sizeof(temp_buffer),
+            "        <div class='card' style='text-align: center; margin-bottom: 20px;'>\n"
+            "            <div class='card-title'>🎥 CURRENT FRAME</div>\n"
+            "            <img src='/frame.jpg?n=%d' width='%d' height='%d' alt='Frame %d'>\n"
+            "        </div>\n",
+            current_frame, FRAME_WIDTH, FRAME_HEIGHT, current_frame
+        );
+        strncat(html_buffer, temp_buffer, buffer_size - strlen(html_buffer) - 1);
+    }
+    for (int i = 0; state->source_count > 1 && i < state->source_count; i++) {
+        const VideoSource* source = &state->sources[i];
+        int frame = i == 0 ? current_frame : source->last_streamed;
+        if (frame <= 0) continue;
+        snprintf(temp_buffer, sizeof(temp_buffer),
+            "        <div class='card' style='text-align: center; margin-bottom: 20px;'>\n"
+            "            <div class='card-title'>🎥 FEED %d - FRAME %d (%d detections)</div>\n"
+            "            <img src='/frame.jpg?feed=%d&amp;n=%d' width='%d' height='%d'"
+            " alt='Feed %d frame %d'>\n"
+            "        </div>\n",
+            i, frame, source->detections, i, frame, FRAME_WIDTH, FRAME_HEIGHT, i, frame
+        );
+        strncat(html_buffer, temp_buffer, buffer_size - strlen(html_buffer) - 1);
+    }
+    
     snprintf(temp_buffer, sizeof(temp_buffer),
         "\n"
         "        <div class='grid'>\n"
@@ -426,7 +456,7 @@ void generate_dashboard_html(SharedMemory* shm, char* html_buffer, size_t buffer
         "\n"
         "        <div class='footer'>\n"
         "            Aviation Monitoring System v1.0 | Real-time Dashboard | "
-        "UDP Streaming Active on Ports 8888, 8889, 9000\n"
+        "UDP Streaming Active on Port 8888\n"
         "        </div>\n"
         "    </div>\n"
         "</body>\n"
@@ -434,8 +464,78 @@ void generate_dashboard_html(SharedMemory* shm, char* html_buffer, size_t buffer
     strncat(html_buffer, footer, buffer_size - strlen(html_buffer) - 1);
 }
 
+// Sends a response's header and body with one writev(), so they leave as
+// one segment where they fit rather than a header-only segment that waits
+// on the client's delayed ACK. Short writes resume where they stopped.
+static void write_response(int client_fd, const char* header, const void* body, size_t length) {
+    struct iovec iov[2];
+    iov[0].iov_base = (void*)header;
+    iov[0].iov_len = strlen(header);
+    iov[1].iov_base = (void*)body;
+    iov[1].iov_len = length;
+    int first = 0;
+    while (first < 2) {
+        ssize_t written = writev(client_fd, iov + first, 2 - first);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        while (first < 2 && (size_t)written >= iov[first].iov_len) {
+            written -= iov[first].iov_len;
+            first++;
+        }
+        if (first < 2) {
+            iov[first].iov_base = (char*)iov[first].iov_base + written;
+            iov[first].iov_len -= written;
+        }
+    }
+}
+
+// GET /frame.jpg[?feed=N]: the frame being played (feed 0) or the one the
+// feed's stream sent last, borrowed from the feed's frame cache
+static void serve_current_frame(SystemState* state, int client_fd, const char* request) {
+    SharedMemory* shm = state->shm;
+    pthread_mutex_lock(&shm->frame_mutex);
+    int current_frame = shm->current_frame;
+    pthread_mutex_unlock(&shm->frame_mutex);
+    
+    FrameCache* cache = state->cache;
+    const char* query = request + strlen("GET /frame.jpg");
+    int feed = strncmp(query, "?feed=", 6) == 0 ? atoi(query + 6) : 0;
+    if (feed > 0) {
+        cache = feed < state->source_count ? state->sources[feed].cache : NULL;
+        current_frame = cache ? state->sources[feed].last_streamed : 0;
+    }
+    
+    const FrameCacheEntry* cached = cache ? frame_cache_try_borrow(cache, current_frame) : NULL;
+    if (!cached || cached->length == 0) {
+        const char* not_found =
+            "HTTP/1.1 404 Not Found\r\n"
+            "Content-Length: 0\r\n"
+            "Connection: close\r\n"
+            "\r\n";
+        write_response(client_fd, not_found, NULL, 0);
+        if (cached) frame_cache_release(cache, cached);
+        return;
+    }
+    
+    char http_header[256];
+    snprintf(http_header, sizeof(http_header),
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: image/jpeg\r\n"
+        "Content-Length: %u\r\n"
+        "Connection: close\r\n"
+        "Cache-Control: no-cache, no-store, must-revalidate\r\n"
+        "\r\n",
+        cached->length
+    );
+    write_response(client_fd, http_header, cached->data, cached->length);
+    frame_cache_release(cache, cached);
+}
+
 void* web_server_thread(void* arg) {
-    SharedMemory* shm = (SharedMemory*)arg;
+    SystemState* state = (SystemState*)arg;
+    SharedMemory* shm = state->shm;
     
     int server_fd, client_fd;
     struct sockaddr_in addr;
@@ -481,8 +581,16 @@ void* web_server_thread(void* arg) {
         client_fd = accept(server_fd, NULL, NULL);
         if (client_fd < 0) continue;
         
-        read(client_fd, buffer, sizeof(buffer));
-        generate_dashboard_html(shm, html_response, HTML_BUFFER_SIZE);
+        ssize_t received = read(client_fd, buffer, sizeof(buffer) - 1);
+        buffer[received > 0 ? received : 0] = '\0';
+        
+        if (strncmp(buffer, "GET /frame.jpg", 14) == 0) {
+            serve_current_frame(state, client_fd, buffer);
+            close(client_fd);
+            continue;
+        }
+        
+        generate_dashboard_html(state, html_response, HTML_BUFFER_SIZE);
         
         char http_header[512];
         snprintf(http_header, sizeof(http_header),
@@ -497,8 +605,7 @@ void* web_server_thread(void* arg) {
             strlen(html_response)
         );
         
-        write(client_fd, http_header, strlen(http_header));
-        write(client_fd, html_response, strlen(html_response));
+        write_response(client_fd, http_header, html_response, strlen(html_response));
         
         close(client_fd);
     }
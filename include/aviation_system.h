@@ -23,13 +23,11 @@ void cleanup_shared_memory(SharedMemory* shm);
 extern "C" {
 #endif
 
-void* video_acquisition_thread(void* arg);
 void* sensor_data_thread(void* arg);
 void* frame_sender_thread(void* arg);
 void* processing_pipeline_thread(void* arg);
 void* detection_thread(void* arg);
 void* watchdog_thread(void* arg);
-void* video_streamer_thread(void* arg);
 
 
 // Sensor initialization
@@ -37,15 +35,103 @@ void initialize_sensor_data(SharedMemory* shm);
 
 // Frame extraction (C++ function)
 bool extract_frames_from_video(SharedMemory* shm);
+void set_extract_workers(int workers);  // 0 = one per online core
+void set_extract_segments(int segments);  // Decoders in segmented mode, 0 = all cores
+void set_extract_mode(int mode);  // EXTRACT_MODE_SEEK / _SEQUENTIAL / _SEGMENTED
+void benchmark_frame_extraction(void);
+
+// Stream frames re-encoded on the quality ladder, whole or as tile deltas (C++ function)
+AdaptiveEncoder* adaptive_encoder_create(int width, int height, bool tiles);
+void adaptive_encoder_destroy(AdaptiveEncoder* encoder);
+void adaptive_encoder_raw(AdaptiveEncoder* encoder, int frame_number,
+                          const unsigned char* pixels, int width, int height);
+const unsigned char* adaptive_encoder_frame(AdaptiveEncoder* encoder, int frame_number,
+                                            const unsigned char* source, uint32_t source_length,
+                                            int* level, uint32_t* length,
+                                            int* width, int* height);
+void adaptive_encoder_force_key(AdaptiveEncoder* encoder);
+void print_adaptive_stats(const char* label, const AdaptiveEncoder* encoder);
+void benchmark_tile_delta();
 
 #ifdef __cplusplus
 }
 #endif
 
+// Frame archive (single mmap'ed file replacing per-frame files)
+bool frame_archive_write(const char* path, int frame_count,
+                         const unsigned char* const* frames, const uint32_t* lengths,
+                         const SensorData* sensors);
+bool frame_archive_open(FrameArchive* archive, const char* path);
+const unsigned char* frame_archive_frame(const FrameArchive* archive, int frame_number,
+                                         uint32_t* length);
+const unsigned char* frame_archive_rendition(const FrameArchive* archive, int frame_number,
+                                             int rendition, uint32_t* length);
+int frame_archive_pick_rendition(const FrameArchive* archive, int max_width);
+const SensorData* frame_archive_sensor(const FrameArchive* archive, int frame_number);
+void frame_archive_close(FrameArchive* archive);
+
+// Outgoing message stream (see chunk_sender.c)
+uint16_t chunk_payload_size(const struct sockaddr_in* dest);
+bool stream_sender_init(StreamSender* sender, int sock, uint16_t chunk_size,
+                        uint16_t fec_group, TokenBucket* bucket);
+bool stream_sender_enable_offload(StreamSender* sender);
+void stream_sender_free(StreamSender* sender);
+bool stream_send_meta(StreamSender* sender, int frame_num, const SensorData* sensor,
+                      const FrameTimes* times, int width, int height);
+bool stream_send_alert(StreamSender* sender, const DetectionResult* detection);
+int send_frame_chunks(StreamSender* sender, int frame_num, const unsigned char* jpeg,
+                      uint32_t length);
+int serve_stream_requests(StreamSender* senders, int sender_count, long long timeout_ns);
+void print_chunk_send_stats(const char* label, const ChunkSendStats* stats);
+bool repair_history_init(RepairHistory* history);
+void repair_history_free(RepairHistory* history);
+void repair_history_store(RepairHistory* history, int frame_num, const unsigned char* jpeg,
+                          uint32_t length, uint16_t chunk_size, uint16_t fec_group);
+void print_repair_stats(const char* label, const RepairHistory* history);
+void benchmark_chunk_send();
+void benchmark_fec();
+void benchmark_fanout();
+void benchmark_segmentation();
+
+// Stream subscribers (see subscribers.c)
+void subscriber_registry_init(SubscriberRegistry* registry);
+int subscriber_join(SubscriberRegistry* registry, const struct sockaddr_in* addr,
+                    uint64_t expires_ns);
+bool subscriber_leave(SubscriberRegistry* registry, const struct sockaddr_in* addr);
+Subscriber* subscriber_lookup(SubscriberRegistry* registry, const struct sockaddr_in* addr);
+Subscriber* subscriber_group_for(SubscriberRegistry* registry, const struct sockaddr_in* from);
+uint64_t subscriber_cookie(const SubscriberRegistry* registry, const struct sockaddr_in* addr,
+                           uint64_t now_ns);
+bool subscriber_cookie_valid(const SubscriberRegistry* registry, const struct sockaddr_in* addr,
+                             uint64_t cookie, uint64_t now_ns);
+int subscriber_expire(SubscriberRegistry* registry, uint64_t now_ns);
+bool parse_stream_target(const char* text, int default_port, struct sockaddr_in* addr);
+void print_subscriber_stats(const char* label, const SubscriberRegistry* registry);
+
+// Bitrate adaptation (see rate_control.c)
+void rate_controller_init(RateController* rate, double max_budget);
+void rate_controller_report(RateController* rate, const WireReport* report,
+                            const struct sockaddr_in* from, uint64_t now_ns);
+int rate_controller_level(RateController* rate, int fps, uint64_t now_ns);
+void rate_controller_frame_sent(RateController* rate, int level, uint32_t length);
+void print_rate_stats(const char* label, const RateController* rate);
+
+// Stream pacing (see pacing.c)
+void token_bucket_init(TokenBucket* bucket, double bytes_per_second, double burst_bytes);
+void token_bucket_consume(TokenBucket* bucket, size_t bytes);
+void pacer_init(StreamPacer* pacer, const char* name, int fps,
+                double bytes_per_second, double burst_bytes);
+void pacer_wait_frame(StreamPacer* pacer, int frame_number);
+long long pacer_ns_until_frame(const StreamPacer* pacer, int frame_number);
+void pacer_frame_sent(StreamPacer* pacer, int frame_number);
+void pacer_report(const StreamPacer* pacer);
+void frame_clock_tick(SharedMemory* shm);
+void tick_follower_init(TickFollower* follower, const char* name);
+int frame_clock_wait(SharedMemory* shm, TickFollower* follower, int timeout_ms);
+void tick_follower_report(const TickFollower* follower);
+
 // UDP functions
 int init_udp_socket();
-void send_video_packet_udp(int socket_fd, VideoPacket* packet);
-void receive_video_packet_udp(int socket_fd, VideoPacket* packet);
 
 // Signal handling
 void init_signal_handlers(SharedMemory* shm);
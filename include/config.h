@@ -3,15 +3,99 @@
 
 #define VIDEO_PATH "./resources/flightfeed.mp4"
 #define FRAMES_DIR "./resources/frames/"
+#define FRAME_ARCHIVE_PATH FRAMES_DIR "frames.pack"
+#define FRAME_ARCHIVE_MAGIC 0x4B415046  /* "FPAK" */
+#define FRAME_ARCHIVE_VERSION 3
+#define MAX_RENDITIONS 4
+#define RENDITION_COUNT 3
+#define RENDITION_WIDTHS { 160, 320, 640 }
+#define RENDITION_HEIGHTS { 120, 240, 480 }
+#define DEFAULT_RENDITION 1
+#define CHUNK_STREAM_WIDTH 320
+#define EXTRACT_MANIFEST_PATH FRAMES_DIR "manifest.txt"
+#define MANIFEST_HASH_BLOCK (1024 * 1024)
+#ifndef EXTRACT_LOOSE_FRAMES
+#define EXTRACT_LOOSE_FRAMES 1
+#endif
+#define EXTRACT_MODE_SEEK 0
+#define EXTRACT_MODE_SEQUENTIAL 1
+#define EXTRACT_MODE_SEGMENTED 2
+#ifndef EXTRACT_MODE
+#define EXTRACT_MODE EXTRACT_MODE_SEQUENTIAL
+#endif
+#ifndef EXTRACT_WORKERS
+#define EXTRACT_WORKERS 0
+#endif
+#ifndef EXTRACT_SEGMENTS
+#define EXTRACT_SEGMENTS 0
+#endif
+#define EXTRACT_QUEUE_DEPTH 16
+#define BENCH_FRAMES_DIR "./resources/bench_frames/"
+#define BENCH_CLIP_SECONDS 30
 #define TOTAL_FRAMES 192
 #define FPS 8
 #define VIDEO_DURATION 24
 #define FRAME_WIDTH 320
 #define FRAME_HEIGHT 240
-#define UDP_PORT 8888
+#define UDP_PORT 8888                       // Client port of the one outgoing stream
+#define UDP_SERVER_PORT 8887                // Server port: subscriptions and NACKs arrive here
 #define UDP_BUFFER_SIZE 65536
 #define LOCALHOST "127.0.0.1"
-#define CLIENT_IP "192.168.1.110"
+
+// Subscribers (see subscribers.c): clients that sent SUBSCRIBE, plus fixed
+// --client / --multicast targets
+#define MAX_SUBSCRIBERS 128
+#define MAX_STREAM_TARGETS 8
+#define SUBSCRIBER_MAX_SEND_FAILURES 64      // Sends refused in a row before a subscriber is dropped
+#define SUBSCRIBE_COOKIE_EPOCH_MS 30000     // A SUBSCRIBE cookie is good for one to two of these
+#define MULTICAST_TTL 1                     // Hops a multicast stream may cross
+#define SEND_BATCH_MESSAGES 256             // Datagrams per sendmmsg() call when fanning out
+
+// Frame chunks of the stream, see chunk_sender.c
+#define CHUNK_PAYLOAD_SIZE 0                // Payload bytes per chunk, 0 = fit the path MTU
+#define CHUNK_PATH_MTU 1500                 // Assumed when the path MTU cannot be probed
+#define CHUNK_SIZE 1024                     // Padded chunk of the old format (--bench-chunks)
+#define CHUNK_BATCH 16                      // Chunks per sendmmsg() call
+#define CHUNK_SEGMENT_OFFLOAD 1             // Hand the kernel runs of chunks (UDP_SEGMENT) if it can
+#define CHUNK_FEC_GROUP 8                   // Data chunks per XOR parity chunk (1/N overhead), 0 = off
+#define REPAIR_HISTORY_FRAMES 16            // Sent frames kept for NACKed resends
+#define REPAIR_MAX_RESENDS 32               // Chunks one subscriber can have resent per frame
+
+// Stream pacing (see pacing.c): average rate and burst, in bytes
+#define STREAM_SEND_RATE (8.0 * 1024 * 1024)
+#define STREAM_SEND_BURST (CHUNK_BATCH * (double)CHUNK_PATH_MTU)  // One sendmmsg() batch
+#define PACE_LATE_THRESHOLD_MS 5            // Frames later than this count as slipped
+#define FRAME_TICK_TIMEOUT_MS 100           // Longest a frame clock follower sleeps between checks
+#define BENCH_CHUNK_FRAMES 40
+#define BENCH_CHUNK_FRAME_BYTES 30500        // Not a multiple of any chunk size, like a real JPEG
+#define BENCH_FEC_FRAMES 400
+#define BENCH_FANOUT_FRAMES 20
+#define BENCH_GSO_FRAMES 400
+
+// Bitrate adaptation (see rate_control.c and adaptive_encoder.c): receiver
+// REPORTs set a byte budget, and each frame is re-encoded at the best level
+// of the ladder whose frames fit it
+#define ADAPTIVE_QUALITY 1                  // 0 = send frames as stored
+#define ADAPT_LEVELS 6
+#define ADAPT_QUALITIES { 90, 75, 60, 45, 60, 40 }  // JPEG quality per level
+#define ADAPT_SCALES { 100, 100, 100, 100, 50, 50 } // Percent of the stream size per level
+#define ADAPT_START_LEVEL 1
+#define ADAPT_LOSS_HIGH 0.05                // Reported loss above this cuts the budget
+#define ADAPT_LOSS_LOW 0.01                 // Loss below this lets it grow again
+#define ADAPT_DECREASE 0.7                  // Cut: this times what the receiver got
+#define ADAPT_INCREASE 1.05                 // Growth per report interval
+#define ADAPT_HOLD_MS 2000                  // No growth or step up this soon after a cut
+#define ADAPT_MIN_RATE (16.0 * 1024)        // Floor of the budget, bytes per second
+#define ADAPT_HEADROOM 0.8                  // Budget share for frames (rest: parity, meta, resends)
+#define ADAPT_CACHE_FRAMES 16               // Recent frames kept raw, with their encodes
+
+// Tile delta coding (see adaptive_encoder.c): between keyframes only the
+// tiles that changed since the last keyframe are sent
+#define TILE_DELTA 1                        // 0 = every frame a whole JPEG
+#define TILE_SIZE 16                        // Pixels, a multiple of the JPEG block
+#define TILE_CHANGE_THRESHOLD 3.0           // Mean absolute pixel difference of a changed tile
+#define TILE_KEYFRAME_INTERVAL 16           // Frames from one keyframe to the next (2 s)
+#define TILE_KEYFRAME_SHARE 0.6             // Send a keyframe once this share of tiles changed
 #define SHM_NAME "/aviation_shm"
 #define SEM_FRAME_READY "/sem_frame_ready"
 #define SEM_PROCESSING_DONE "/sem_processing_done"
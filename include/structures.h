@@ -4,7 +4,12 @@
 #include <pthread.h>
 #include <semaphore.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
 #include <time.h>
+#include <netinet/in.h>
+#include "config.h"
+#include "wire_protocol.h"
 
 // Sensor data structure
 typedef struct {
@@ -15,8 +20,16 @@ typedef struct {
     double longitude;
     time_t timestamp;
     bool is_valid;
+    uint64_t time_ns;           // When the reading was taken (CLOCK_REALTIME ns)
 } SensorData;
 
+// When a frame was captured and encoded (CLOCK_REALTIME ns, 0 = unknown);
+// travels with the frame and goes out in its META message
+typedef struct {
+    uint64_t capture_ns;
+    uint64_t encode_ns;
+} FrameTimes;
+
 // Detection result structure
 typedef struct {
     int frame_number;
@@ -26,14 +39,167 @@ typedef struct {
     SensorData sensor_snapshot;
 } DetectionResult;
 
-// UDP packet for video frame (PPM format)
+// Packed frame archive: header, frame index, then JPEG payloads
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t frame_count;
+    uint32_t frame_width;
+    uint32_t frame_height;
+    uint32_t fps;
+    uint64_t index_offset;
+    uint64_t payload_offset;
+    uint32_t rendition_count;
+    uint32_t default_rendition;
+    uint32_t rendition_width[MAX_RENDITIONS];
+    uint32_t rendition_height[MAX_RENDITIONS];
+} FrameArchiveHeader;
+
+typedef struct {
+    uint64_t offset[MAX_RENDITIONS];    // Payload offsets from start of file
+    uint32_t length[MAX_RENDITIONS];    // JPEG sizes in bytes
+    SensorData sensor;                  // Sensor record captured with the frame
+} FrameIndexEntry;
+
+// Read-only mapping of an archive (see frame_archive.c)
+typedef struct {
+    void* base;
+    size_t size;
+    const FrameArchiveHeader* header;
+    const FrameIndexEntry* index;
+} FrameArchive;
+
+// Fixed-size chunk of the old frame chunk format, always padded to CHUNK_SIZE.
+// Only the --bench-chunks baseline still sends it; see wire_protocol.h.
+typedef struct {
+    int frame_num;
+    int chunk_id;
+    int total_chunks;
+    int chunk_size;
+    char data[CHUNK_SIZE];
+} FrameChunk;
+
+// Token bucket capping a stream's burst and average bitrate
+typedef struct {
+    double rate;                // Bytes per second
+    double burst;               // Bucket depth in bytes
+    double tokens;
+    struct timespec last_refill;
+    double wait_seconds;        // Total time spent waiting for tokens
+} TokenBucket;
+
+// Absolute-schedule pacer for one outgoing stream (see pacing.c)
+typedef struct {
+    const char* name;
+    long period_ns;             // 0 = unscheduled (live mode)
+    TokenBucket bucket;
+    long frames;
+    long late_frames;           // Sent more than PACE_LATE_THRESHOLD_MS late
+    double late_total;
+    double late_max;
+    double late_last;           // Lateness of the previous frame
+    double jitter;              // Smoothed change in lateness frame to frame
+} StreamPacer;
+
+// A thread that acts on frame clock ticks instead of polling (see pacing.c)
+typedef struct {
+    const char* name;
+    int frame;                  // Last frame picked up
+    long ticks;
+    long skipped;               // Frames published while it was busy
+    double lag_total;           // Tick to pickup, seconds
+    double lag_max;
+} TickFollower;
+
+typedef struct {
+    long frames;
+    long chunks;
+    long syscalls;
+    long datagrams;             // Chunks times destinations, resends included
+    long offloaded;             // Of those, sent inside a UDP_SEGMENT run
+    long send_failures;         // Sends one destination refused (the rest went on)
+    long wire_bytes;            // UDP payload bytes, headers included
+    double send_seconds;        // Summed first-submit to last-return time
+    double max_send_seconds;
+} ChunkSendStats;
+
+// Copy of a recently sent frame, kept to answer NACKs for its chunks
+typedef struct {
+    unsigned char* data;        // WIRE_MAX_FRAME_BYTES
+    uint32_t length;
+    int frame_num;              // 0 = empty
+    uint16_t chunk_size;
+    uint16_t fec_group;
+    struct timespec sent_at;
+} SentFrame;
+
+typedef struct {
+    SentFrame frames[REPAIR_HISTORY_FRAMES];
+    long nacks;
+    long nacks_expired;         // Frame past WIRE_REPAIR_DEADLINE_MS or no longer held
+    long nacks_refused;         // From an address that is not subscribed
+    long chunks_refused;        // Over REPAIR_MAX_RESENDS for the requester and frame
+    long chunks_resent;
+} RepairHistory;
+
+// One destination of the stream
 typedef struct {
-    int frame_id;
-    char frame_path[256];
-    int frame_width;
-    int frame_height;
-    SensorData sensor;
-} VideoPacket;
+    struct sockaddr_in addr;
+    uint64_t expires_ns;        // Lease end (wire_now_ns), 0 = fixed target
+    // Chunks resent to it, per repair history slot (frame n in n % REPAIR_HISTORY_FRAMES)
+    int resend_frame[REPAIR_HISTORY_FRAMES];
+    int resent[REPAIR_HISTORY_FRAMES];
+    int send_failures;          // Sends to it refused in a row (no route, firewall...)
+} Subscriber;
+
+typedef struct {
+    Subscriber entries[MAX_SUBSCRIBERS];
+    int count;
+    long joined;
+    long left;
+    long expired;
+    long evicted;               // Dropped after SUBSCRIBER_MAX_SEND_FAILURES
+    uint64_t cookie_key[2];     // Keys the SUBSCRIBE cookies, drawn at start-up
+    long challenged;            // SUBSCRIBEs answered with a COOKIE instead
+} SubscriberRegistry;
+
+// Byte budget of the stream, set from receiver REPORTs, and the encoding
+// level that fits it (see rate_control.c)
+typedef struct {
+    double budget;              // Bytes per second the worst receiver gets through
+    double max_budget;
+    int level;                  // Ladder step in use, 0 = best
+    double frame_bytes[ADAPT_LEVELS];   // Average encoded frame per level, 0 = not seen yet
+    uint64_t last_cut_ns;       // wire_now_ns of the last budget cut
+    uint64_t last_growth_ns;
+    double window_loss;         // Worst loss reported since the last growth check
+    long reports;
+    long reports_refused;       // From an address that is not subscribed
+    long cuts;
+    long level_changes;
+} RateController;
+
+// One feed's outgoing message stream: META, ALERT and CHUNK messages from
+// one socket (shared by the streams of all feeds), each encoded once and
+// sent to every subscriber of the feed (see chunk_sender.c)
+typedef struct {
+    int sock;
+    uint8_t source_id;          // Feed this stream carries, 0 = primary
+    SubscriberRegistry subscribers;
+    uint32_t sequence;          // Of the next message
+    uint16_t chunk_size;        // Chunk payload bytes
+    uint16_t fec_group;         // Data chunks per parity chunk, 0 = no FEC
+    bool segment_offload;       // Runs of chunks go out as one UDP_SEGMENT send
+    TokenBucket* bucket;
+    ChunkSendStats stats;       // Every message, chunks and resends included
+    RepairHistory repairs;
+    RateController rate;        // Fed by REPORTs
+    long meta_sent;
+    long alerts_sent;
+} StreamSender;
+
+// Re-encodes stream frames on the quality ladder (opaque, C++ implemented)
+typedef struct AdaptiveEncoder AdaptiveEncoder;
 
 // Shared memory structure - UPDATED for 160 frames
 typedef struct {
@@ -68,13 +234,19 @@ typedef struct {
     // Condition variables
     pthread_cond_t ui_update_cond;
     pthread_mutex_t ui_mutex;
+    
+    // Frame clock: broadcast (under frame_mutex) as each frame is published
+    pthread_cond_t frame_tick_cond;
+    uint64_t frame_tick_ns;         // CLOCK_MONOTONIC time of the last tick
 } SharedMemory;
 
 // System state for main
 typedef struct {
     SharedMemory* shm;
     int udp_socket;
-    pthread_t threads[7];
+    struct sockaddr_in targets[MAX_STREAM_TARGETS];  // --client / --multicast
+    int target_count;
+    pthread_t threads[5];
 } SystemState;
 
 #endif
@@ -0,0 +1,244 @@
+#include "../include/wire_protocol.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/udp.h>
+
+#ifndef UDP_GRO
+#define UDP_GRO 104                     // linux/udp.h, kernel 5.0+
+#endif
+
+// Rebuilds frames from the stream's CHUNK messages. Up to WIRE_REASSEMBLY_SLOTS
+// frames are assembled at once, frame n in slot n % WIRE_REASSEMBLY_SLOTS;
+// a newer frame evicts whatever is left in its slot. When a chunk group has
+// its parity chunk and exactly one data chunk missing, that chunk is rebuilt
+// on the spot (no round trip to the sender). Whatever parity cannot cover
+// is asked for again with NACKs until the repair deadline, and a frame still
+// incomplete at WIRE_FRAME_TIMEOUT_MS is dropped rather than ever handed on.
+
+#define HAS(bits, i) ((bits)[(i) / 8] & (1u << ((i) % 8)))
+#define SET(bits, i) ((bits)[(i) / 8] |= (uint8_t)(1u << ((i) % 8)))
+
+bool wire_reassembler_init(WireReassembler* reassembler) {
+    memset(reassembler, 0, sizeof(*reassembler));
+    for (int i = 0; i < WIRE_REASSEMBLY_SLOTS; i++) {
+        WireFrameSlot* slot = &reassembler->slots[i];
+        slot->data = (uint8_t*)malloc(WIRE_MAX_FRAME_BYTES);
+        // One parity payload per group: at most one per data chunk
+        slot->parity = (uint8_t*)malloc(WIRE_MAX_FRAME_BYTES + WIRE_MAX_DATAGRAM);
+        if (!slot->data || !slot->parity) {
+            wire_reassembler_free(reassembler);
+            return false;
+        }
+    }
+    return true;
+}
+
+void wire_reassembler_free(WireReassembler* reassembler) {
+    for (int i = 0; i < WIRE_REASSEMBLY_SLOTS; i++) {
+        free(reassembler->slots[i].data);
+        free(reassembler->slots[i].parity);
+        reassembler->slots[i].data = NULL;
+        reassembler->slots[i].parity = NULL;
+    }
+}
+
+static void slot_reset(WireReassembler* reassembler, WireFrameSlot* slot,
+                       const WireChunkHeader* chunk, uint64_t now_ns) {
+    if (slot->frame_num != 0 && !slot->complete && !slot->timed_out) {
+        reassembler->frames_abandoned++;
+    }
+    slot->frame_num = chunk->header.frame_id;
+    slot->frame_length = chunk->frame_length;
+    slot->total_chunks = chunk->total_chunks;
+    slot->chunk_size = chunk->chunk_size;
+    slot->fec_group = chunk->fec_group;
+    slot->chunks_received = 0;
+    slot->chunks_rebuilt = 0;
+    slot->complete = false;
+    slot->timed_out = false;
+    slot->first_arrival_ns = now_ns;
+    slot->last_nack_ns = 0;
+    memset(slot->have, 0, sizeof(slot->have));
+    memset(slot->have_parity, 0, sizeof(slot->have_parity));
+}
+
+// Rebuilds the one missing data chunk of `group`, if that is all it lacks.
+// The parity payload is XORed with every chunk that did arrive, in place.
+static void slot_try_repair(WireReassembler* reassembler, WireFrameSlot* slot, int group) {
+    if (!HAS(slot->have_parity, group)) return;
+
+    int first = group * slot->fec_group;
+    int last = first + slot->fec_group;
+    if (last > slot->total_chunks) last = slot->total_chunks;
+
+    int missing = -1;
+    for (int i = first; i < last; i++) {
+        if (HAS(slot->have, i)) continue;
+        if (missing >= 0) return;   // Two or more lost: parity cannot help
+        missing = i;
+    }
+    if (missing < 0) return;
+
+    uint8_t* rebuilt = slot->parity + (size_t)group * slot->chunk_size;
+    for (int i = first; i < last; i++) {
+        if (i == missing) continue;
+        wire_xor(rebuilt, slot->data + (size_t)i * slot->chunk_size,
+                 wire_chunk_length(slot->frame_length, slot->chunk_size, i));
+    }
+    memcpy(slot->data + (size_t)missing * slot->chunk_size, rebuilt,
+           wire_chunk_length(slot->frame_length, slot->chunk_size, missing));
+    SET(slot->have, missing);
+    slot->chunks_received++;
+    slot->chunks_rebuilt++;
+    reassembler->chunks_rebuilt++;
+}
+
+// Takes one datagram. Returns the slot holding its frame if this datagram
+// completed the frame, else NULL (incomplete, duplicate, stale or invalid).
+const WireFrameSlot* wire_reassembler_add(WireReassembler* reassembler,
+                                          const uint8_t* datagram, size_t length,
+                                          uint64_t now_ns) {
+    WireChunkHeader chunk;
+    if (!wire_chunk_header_decode(datagram, length, &chunk) || chunk.header.frame_id == 0) {
+        return NULL;
+    }
+
+    uint32_t frame_num = chunk.header.frame_id;
+    WireFrameSlot* slot = &reassembler->slots[frame_num % WIRE_REASSEMBLY_SLOTS];
+    if (slot->frame_num != frame_num) {
+        // A late chunk of a frame already evicted; anything further back
+        // means the sender restarted its numbering
+        if (slot->frame_num > frame_num &&
+            slot->frame_num - frame_num < 2 * WIRE_REASSEMBLY_SLOTS) {
+            return NULL;
+        }
+        slot_reset(reassembler, slot, &chunk, now_ns);
+    }
+    if (slot->complete || slot->timed_out || chunk.frame_length != slot->frame_length ||
+        chunk.chunk_size != slot->chunk_size || chunk.fec_group != slot->fec_group) {
+        return NULL;
+    }
+
+    slot->last_arrival_ns = now_ns;
+    const uint8_t* payload = datagram + WIRE_CHUNK_HEADER_SIZE;
+    int group;
+    if (chunk.flags & WIRE_CHUNK_PARITY) {
+        group = chunk.chunk_id;
+        if (HAS(slot->have_parity, group)) return NULL;
+        SET(slot->have_parity, group);
+        memcpy(slot->parity + (size_t)group * slot->chunk_size, payload, chunk.payload_length);
+    } else {
+        if (HAS(slot->have, chunk.chunk_id)) return NULL;
+        SET(slot->have, chunk.chunk_id);
+        memcpy(slot->data + (size_t)chunk.chunk_id * slot->chunk_size, payload,
+               chunk.payload_length);
+        slot->chunks_received++;
+        group = slot->fec_group ? chunk.chunk_id / slot->fec_group : -1;
+    }
+    if (group >= 0) slot_try_repair(reassembler, slot, group);
+
+    if (slot->chunks_received < slot->total_chunks) return NULL;
+    slot->complete = true;
+    reassembler->frames_completed++;
+    if (slot->chunks_rebuilt > 0) reassembler->frames_repaired++;
+    if (slot->last_nack_ns != 0) reassembler->frames_nack_repaired++;
+    return slot;
+}
+
+// Finds the next incomplete frame due a NACK: its chunks have stopped
+// arriving for WIRE_NACK_DELAY_MS, it was not NACKed in the last
+// WIRE_NACK_RETRY_MS, and it is younger than WIRE_REPAIR_DEADLINE_MS.
+// Fills *nack with its missing data chunks; the caller stamps the header's
+// sequence, timestamp and source_id before sending. Call until it returns
+// false.
+bool wire_reassembler_next_nack(WireReassembler* reassembler, uint64_t now_ns, WireNack* nack) {
+    const uint64_t ms = 1000000ULL;
+    for (int i = 0; i < WIRE_REASSEMBLY_SLOTS; i++) {
+        WireFrameSlot* slot = &reassembler->slots[i];
+        if (slot->frame_num == 0 || slot->complete || slot->timed_out ||
+            now_ns - slot->first_arrival_ns >= WIRE_REPAIR_DEADLINE_MS * ms ||
+            now_ns - slot->last_arrival_ns < WIRE_NACK_DELAY_MS * ms ||
+            (slot->last_nack_ns != 0 && now_ns - slot->last_nack_ns < WIRE_NACK_RETRY_MS * ms)) {
+            continue;
+        }
+
+        int first = 0;
+        while (HAS(slot->have, first)) first++;
+        int last = slot->total_chunks - 1;
+        while (HAS(slot->have, last)) last--;
+
+        memset(nack, 0, sizeof(*nack));
+        nack->header.frame_id = slot->frame_num;
+        nack->first_chunk = (uint16_t)first;
+        nack->chunk_count = (uint16_t)(last - first + 1);
+        for (int c = first; c <= last; c++) {
+            if (HAS(slot->have, c)) continue;
+            SET(nack->missing, c - first);
+            reassembler->chunks_requested++;
+        }
+
+        slot->last_nack_ns = now_ns;
+        reassembler->nacks_sent++;
+        return true;
+    }
+    return false;
+}
+
+// Drops the frames still incomplete WIRE_FRAME_TIMEOUT_MS after their
+// first chunk. Their slots keep the frame number, so chunks that straggle
+// in later cannot start the frame over. Returns how many were dropped.
+int wire_reassembler_expire(WireReassembler* reassembler, uint64_t now_ns) {
+    int dropped = 0;
+    for (int i = 0; i < WIRE_REASSEMBLY_SLOTS; i++) {
+        WireFrameSlot* slot = &reassembler->slots[i];
+        if (slot->frame_num == 0 || slot->complete || slot->timed_out ||
+            now_ns - slot->first_arrival_ns < WIRE_FRAME_TIMEOUT_MS * 1000000ULL) {
+            continue;
+        }
+        slot->timed_out = true;
+        reassembler->frames_timed_out++;
+        dropped++;
+    }
+    return dropped;
+}
+
+// Asks the kernel to hand over runs of equal-sized datagrams in one read.
+// Returns false if it cannot (each datagram is then read alone).
+bool wire_enable_gro(int sock) {
+    int on = 1;
+    return setsockopt(sock, IPPROTO_UDP, UDP_GRO, &on, sizeof(on)) == 0;
+}
+
+// One non-blocking read: a datagram, or with GRO a run of them. Returns the
+// bytes read (<= 0 as recvfrom() would); *segment_size gets the size of
+// each datagram in the run (the last may be shorter), or the whole length.
+// The buffer should hold WIRE_MAX_DATAGRAM bytes.
+ssize_t wire_receive(int sock, uint8_t* buffer, size_t size, struct sockaddr_in* from,
+                     size_t* segment_size) {
+    struct iovec iov;
+    iov.iov_base = buffer;
+    iov.iov_len = size;
+    size_t control[CMSG_SPACE(sizeof(int)) / sizeof(size_t)];     // Aligned for cmsghdr
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_name = from;
+    message.msg_namelen = from ? sizeof(*from) : 0;
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    ssize_t received = recvmsg(sock, &message, MSG_DONTWAIT);
+    *segment_size = received > 0 ? (size_t)received : 0;
+    if (received <= 0) return received;
+
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+        if (cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO) {
+            int gso_size;
+            memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+            if (gso_size > 0) *segment_size = (size_t)gso_size;
+        }
+    }
+    return received;
+}
@@ -10,11 +10,13 @@ void* detection_thread(void* arg) {
     bool detected_frame1 = false;
     bool detected_frame2 = false;
     int last_checked_frame = 0;
+    TickFollower clock;
+    tick_follower_init(&clock, "detection");
     
     while (shm->system_active) {
-        pthread_mutex_lock(&shm->frame_mutex);
-        int current = shm->current_frame;
-        pthread_mutex_unlock(&shm->frame_mutex);
+        // Woken by each frame as the stream publishes it, so no frame is
+        // skipped between polls
+        int current = frame_clock_wait(shm, &clock, FRAME_TICK_TIMEOUT_MS);
         
         // Only process if frame has changed
         if (current != last_checked_frame && current > 0) {
@@ -100,10 +102,9 @@ void* detection_thread(void* arg) {
                 pthread_mutex_unlock(&shm->ui_mutex);
             }
         }
-        
-        usleep(10000);  // Check every 10ms (faster polling to not miss frames)
     }
     
+    tick_follower_report(&clock);
     printf("[DetectionThread] Stopped\n");
     return NULL;
 }
@@ -1,19 +1,15 @@
 #include "../include/aviation_system.h"
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
 
-#define UDP_FRAME_PORT 8889
-#define CHUNK_SIZE 1024
-#define MAX_CHUNKS 300
-
-typedef struct {
-    int frame_num;
-    int chunk_id;
-    int total_chunks;
-    int chunk_size;
-    char data[CHUNK_SIZE];
-} FrameChunk;
+// The stream is the server's one frame clock: a frame becomes the current
+// frame (for the sensor, detection, pipeline and UI threads) as it goes
+// out, and the threads waiting on the tick wake up
+static void publish_current_frame(SharedMemory* shm, int frame) {
+    pthread_mutex_lock(&shm->frame_mutex);
+    shm->current_frame = frame;
+    shm->total_frames_processed++;
+    frame_clock_tick(shm);
+    pthread_mutex_unlock(&shm->frame_mutex);
+}
 
 void* frame_sender_thread(void* arg) {
     SystemState* state = (SystemState*)arg;
@@ -25,71 +21,161 @@ void* frame_sender_thread(void* arg) {
     
     if (!shm->system_active) return NULL;
     
-    printf("[FrameSender] Starting UDP frame transmission on port %d\n", UDP_FRAME_PORT);
+    printf("[FrameSender] Starting UDP stream on port %d\n", UDP_PORT);
+    
+    // Chunks carry only used bytes, each filling one datagram on the path MTU
+    // of the first fixed target (subscribers joining later are assumed to sit
+    // behind a CHUNK_PATH_MTU link); every CHUNK_FEC_GROUP of them are
+    // followed by an XOR parity chunk
+    uint16_t chunk_size = chunk_payload_size(state->target_count > 0 ? &state->targets[0] : NULL);
+    printf("[FrameSender] Sending meta, alerts and frames to subscribers on port %d "
+           "(%u-byte chunks, FEC 1/%d)\n", UDP_SERVER_PORT, chunk_size, CHUNK_FEC_GROUP);
+    
+    FrameArchive archive;
+    if (!frame_archive_open(&archive, FRAME_ARCHIVE_PATH)) {
+        printf("[FrameSender] Error: Cannot map %s\n", FRAME_ARCHIVE_PATH);
+        return NULL;
+    }
+    int rendition = frame_archive_pick_rendition(&archive, CHUNK_STREAM_WIDTH);
+    int width = (int)archive.header->rendition_width[rendition];
+    int height = (int)archive.header->rendition_height[rendition];
     
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-        perror("[FrameSender] Socket creation failed");
+    // Every message of the stream draws on one token bucket
+    StreamPacer pacer;
+    pacer_init(&pacer, "stream", FPS, STREAM_SEND_RATE, STREAM_SEND_BURST);
+    StreamSender sender;
+    if (!stream_sender_init(&sender, state->udp_socket, chunk_size, CHUNK_FEC_GROUP,
+                            &pacer.bucket)) {
+        printf("[FrameSender] Error: Cannot allocate repair history\n");
+        frame_archive_close(&archive);
         return NULL;
     }
     
-    struct sockaddr_in dest_addr;
-    dest_addr.sin_family = AF_INET;
-    dest_addr.sin_port = htons(UDP_FRAME_PORT);
-    dest_addr.sin_addr.s_addr = inet_addr(CLIENT_IP);
+    // Where the kernel supports it, runs of chunks go out as single buffers
+    // that it splits into datagrams itself
+    if (CHUNK_SEGMENT_OFFLOAD && stream_sender_enable_offload(&sender)) {
+        printf("[FrameSender] ✓ UDP segmentation offload enabled\n");
+    } else if (CHUNK_SEGMENT_OFFLOAD) {
+        printf("[FrameSender] UDP_SEGMENT not supported, sending one datagram per chunk\n");
+    }
     
-    printf("[FrameSender] Sending frames to %s:%d\n", CLIENT_IP, UDP_FRAME_PORT);
+    // --client and --multicast targets never expire; clients that SUBSCRIBE
+    // come and go while the stream runs
+    for (int t = 0; t < state->target_count; t++) {
+        subscriber_join(&sender.subscribers, &state->targets[t], 0);
+    }
+    
+    // Frames are re-encoded to fit what the receivers report getting through,
+    // and/or as tile deltas, from the widest rendition (the closest the
+    // archive has to raw frames)
+    AdaptiveEncoder* encoder = NULL;
+    int source_rendition = (int)archive.header->rendition_count - 1;
+    if (ADAPTIVE_QUALITY || TILE_DELTA) {
+        encoder = adaptive_encoder_create(width, height, TILE_DELTA);
+        printf("[FrameSender] ✓ Re-encoding from %ux%u frames (%s%s)\n",
+               archive.header->rendition_width[source_rendition],
+               archive.header->rendition_height[source_rendition],
+               ADAPTIVE_QUALITY ? "adaptive quality" : "fixed quality",
+               TILE_DELTA ? ", tile deltas" : "");
+    }
     
+    int last_alert = 0;
     for (int frame = 1; frame <= TOTAL_FRAMES && shm->system_active; frame++) {
-        char filename[256];
-        snprintf(filename, sizeof(filename), "resources/frames/frame_%03d.jpg", frame);
+        // NACKs for earlier frames are answered while waiting for this one
+        long joined = sender.subscribers.joined;
+        long long wait;
+        do {
+            wait = pacer_ns_until_frame(&pacer, frame);
+            serve_stream_requests(&sender, 1, wait);
+        } while (wait > 0 && shm->system_active);
+        subscriber_expire(&sender.subscribers, wire_now_ns());
+        publish_current_frame(shm, frame);
         
-        int fd = open(filename, O_RDONLY);
-        if (fd < 0) {
-            printf("[FrameSender] Warning: Cannot open %s\n", filename);
+        // Archived frames were encoded at extraction; they enter the stream now
+        FrameTimes times;
+        times.capture_ns = wire_realtime_ns();
+        times.encode_ns = times.capture_ns;
+        uint32_t filesize;
+        const unsigned char* jpeg = frame_archive_rendition(&archive, frame,
+                                                            encoder ? source_rendition : rendition,
+                                                            &filesize);
+        if (!jpeg) {
+            printf("[FrameSender] Warning: Frame %d missing from archive\n", frame);
             continue;
         }
-        
-        struct stat st;
-        fstat(fd, &st);
-        int filesize = st.st_size;
-        
-        // Calculate number of chunks needed
-        int total_chunks = (filesize + CHUNK_SIZE - 1) / CHUNK_SIZE;
-        if (total_chunks > MAX_CHUNKS) {
-            printf("[FrameSender] Warning: Frame %d too large, skipping\n", frame);
-            close(fd);
-            continue;
+        int level = 0;
+        int frame_width = width;
+        int frame_height = height;
+        if (encoder) {
+            // Whoever just joined has no keyframe to apply deltas to
+            if (sender.subscribers.joined != joined) adaptive_encoder_force_key(encoder);
+            level = ADAPTIVE_QUALITY ? rate_controller_level(&sender.rate, FPS, wire_now_ns())
+                                     : ADAPT_START_LEVEL;
+            jpeg = adaptive_encoder_frame(encoder, frame, jpeg, filesize, &level, &filesize,
+                                          &frame_width, &frame_height);
+            if (!jpeg) {
+                printf("[FrameSender] Warning: Frame %d cannot be re-encoded\n", frame);
+                adaptive_encoder_force_key(encoder);
+                continue;
+            }
+            times.encode_ns = wire_realtime_ns();
         }
         
-        // Send frame in chunks
-        char buffer[CHUNK_SIZE];
-        int chunk_id = 0;
-        int bytes_read;
+        // Sensor record first, so the client has it when the pixels complete
+        SensorData sensor;
+        pthread_mutex_lock(&shm->sensor_mutex);
+        sensor = shm->frame_sensors[frame - 1];
+        pthread_mutex_unlock(&shm->sensor_mutex);
+        sensor.time_ns = times.capture_ns;      // Taken as the frame enters the stream
+        stream_send_meta(&sender, frame, &sensor, &times, frame_width, frame_height);
         
-        while ((bytes_read = read(fd, buffer, CHUNK_SIZE)) > 0 && chunk_id < total_chunks) {
-            FrameChunk chunk;
-            chunk.frame_num = frame;
-            chunk.chunk_id = chunk_id;
-            chunk.total_chunks = total_chunks;
-            chunk.chunk_size = bytes_read;
-            memcpy(chunk.data, buffer, bytes_read);
-            
-            sendto(sock, &chunk, sizeof(FrameChunk), 0,
-                   (struct sockaddr*)&dest_addr, sizeof(dest_addr));
-            
-            chunk_id++;
-            usleep(1000);  // Small delay between chunks
+        // Each new detection is announced once; the UI keeps its own flag
+        DetectionResult detection;
+        bool alert = false;
+        pthread_mutex_lock(&shm->detection_mutex);
+        if (shm->latest_detection.obstacle_detected &&
+            shm->latest_detection.frame_number != last_alert) {
+            detection = shm->latest_detection;
+            last_alert = detection.frame_number;
+            alert = true;
         }
+        pthread_mutex_unlock(&shm->detection_mutex);
+        if (alert) stream_send_alert(&sender, &detection);
         
-        close(fd);
-        printf("[FrameSender] Sent frame %d (%d chunks)\n", frame, total_chunks);
+        // All chunks of the frame go out in a few sendmmsg() batches, straight
+        // from the mapping; the stream's token bucket spaces the batches
+        int datagrams = send_frame_chunks(&sender, frame, jpeg, filesize);
+        if (datagrams < 0) {
+            printf("[FrameSender] Warning: Frame %d not sent (%u bytes)\n", frame, filesize);
+            // It may have been the keyframe the next deltas refer to
+            if (encoder) adaptive_encoder_force_key(encoder);
+            continue;
+        }
         
-        usleep(125000);  // 8 FPS delay
+        if (encoder) rate_controller_frame_sent(&sender.rate, level, filesize);
+        pacer_frame_sent(&pacer, frame);
+        printf("[FrameSender] Sent frame %d (%d datagrams)\n", frame, datagrams);
     }
     
-    printf("[FrameSender] All frames sent\n");
-    close(sock);
+    // Keep answering NACKs until the last frame is past its repair deadline
+    uint64_t linger_until = wire_now_ns() + WIRE_REPAIR_DEADLINE_MS * 1000000ULL;
+    for (uint64_t now = wire_now_ns(); now < linger_until && shm->system_active;
+         now = wire_now_ns()) {
+        serve_stream_requests(&sender, 1, (long long)(linger_until - now));
+    }
+    
+    frame_archive_close(&archive);
+    printf("[FrameSender] All frames sent (%ld meta, %ld alerts)\n",
+           sender.meta_sent, sender.alerts_sent);
+    print_chunk_send_stats("[FrameSender]", &sender.stats);
+    print_repair_stats("[FrameSender]", &sender.repairs);
+    print_subscriber_stats("[FrameSender]", &sender.subscribers);
+    if (encoder) {
+        if (ADAPTIVE_QUALITY) print_rate_stats("[FrameSender]", &sender.rate);
+        print_adaptive_stats("[FrameSender]", encoder);
+        adaptive_encoder_destroy(encoder);
+    }
+    stream_sender_free(&sender);
+    pacer_report(&pacer);
     return NULL;
 }
-
@@ -1,10 +1,86 @@
 #include "../include/aviation_system.h"
 
-int main() {
+static void print_usage(const char* prog) {
+    printf("Usage: %s [--mode seek|sequential|segmented] [--workers N] [--segments N]"
+           " [--client IP[:PORT]]... [--multicast GROUP[:PORT]]\n"
+           "          [--bench-extract] [--bench-chunks] [--bench-fec] [--bench-fanout] [--bench-gso]\n"
+           "          [--bench-tiles]\n", prog);
+    printf("  --mode M          Extraction decode strategy (default: sequential)\n");
+    printf("  --workers N       Encode/write worker threads for extraction (0 = all cores)\n");
+    printf("  --segments N      Parallel decoders in segmented mode (0 = all cores)\n");
+    printf("  --client IP[:PORT]   Always stream to this client (repeatable; default port %d)\n",
+           UDP_PORT);
+    printf("  --multicast GROUP[:PORT]  Stream to a multicast group (TTL %d)\n", MULTICAST_TTL);
+    printf("  (clients may also SUBSCRIBE to UDP port %d at any time)\n", UDP_SERVER_PORT);
+    printf("  --bench-extract   Measure extraction scaling from 1 worker to all cores\n");
+    printf("  --bench-chunks    Compare per-chunk sendto() with batched sendmmsg()\n");
+    printf("  --bench-fec       Frame completion vs FEC/NACK overhead under injected loss\n");
+    printf("  --bench-fanout    Per-subscriber sends vs encode-once fan-out to 1-100 clients\n");
+    printf("  --bench-gso       CPU per frame with and without UDP_SEGMENT / UDP_GRO\n");
+    printf("  --bench-tiles     Bytes per frame, whole JPEGs vs tile deltas, on the archived clip\n");
+}
+
+int main(int argc, char* argv[]) {
+    struct sockaddr_in targets[MAX_STREAM_TARGETS];
+    int target_count = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "seek") == 0) {
+                set_extract_mode(EXTRACT_MODE_SEEK);
+            } else if (strcmp(mode, "sequential") == 0) {
+                set_extract_mode(EXTRACT_MODE_SEQUENTIAL);
+            } else if (strcmp(mode, "segmented") == 0) {
+                set_extract_mode(EXTRACT_MODE_SEGMENTED);
+            } else {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            set_extract_workers(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--segments") == 0 && i + 1 < argc) {
+            set_extract_segments(atoi(argv[++i]));
+        } else if ((strcmp(argv[i], "--client") == 0 || strcmp(argv[i], "--multicast") == 0) &&
+                   i + 1 < argc) {
+            bool multicast = strcmp(argv[i], "--multicast") == 0;
+            struct sockaddr_in* target = &targets[target_count];
+            if (target_count == MAX_STREAM_TARGETS ||
+                !parse_stream_target(argv[++i], UDP_PORT, target) ||
+                multicast != IN_MULTICAST(ntohl(target->sin_addr.s_addr))) {
+                print_usage(argv[0]);
+                return 1;
+            }
+            target_count++;
+        } else if (strcmp(argv[i], "--bench-extract") == 0) {
+            benchmark_frame_extraction();
+            return 0;
+        } else if (strcmp(argv[i], "--bench-chunks") == 0) {
+            benchmark_chunk_send();
+            return 0;
+        } else if (strcmp(argv[i], "--bench-fec") == 0) {
+            benchmark_fec();
+            return 0;
+        } else if (strcmp(argv[i], "--bench-fanout") == 0) {
+            benchmark_fanout();
+            return 0;
+        } else if (strcmp(argv[i], "--bench-gso") == 0) {
+            benchmark_segmentation();
+            return 0;
+        } else if (strcmp(argv[i], "--bench-tiles") == 0) {
+            benchmark_tile_delta();
+            return 0;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    
     printf("\n");
     printf("╔═══════════════════════════════════════════════════════════╗\n");
     printf("║   AVIATION SERVER - COMPLETE STREAMING MODE              ║\n");
-    printf("║  UDP: 8888 (meta) | 8889 (frames) | 9000 (video)         ║\n");
+    printf("║  UDP: 8888 (meta + alerts + frames, one stream)          ║\n");
+    printf("║  UDP: 8887 (subscriptions and NACKs from clients)        ║\n");
     printf("╚═══════════════════════════════════════════════════════════╝\n");
     printf("\n");
     
@@ -34,21 +110,23 @@ int main() {
     SystemState state;
     state.shm = shm;
     state.udp_socket = udp_socket;
+    memcpy(state.targets, targets, sizeof(targets));
+    state.target_count = target_count;
     
-    printf("[Server] Starting 7 threads...\n\n");
+    printf("[Server] Starting 5 threads...\n\n");
     
+    // The frame sender also advances the current frame the others follow
     pthread_create(&state.threads[0], NULL, sensor_data_thread, shm);
-    pthread_create(&state.threads[1], NULL, video_acquisition_thread, &state);
+    pthread_create(&state.threads[1], NULL, frame_sender_thread, &state);
     pthread_create(&state.threads[2], NULL, detection_thread, shm);
     pthread_create(&state.threads[3], NULL, processing_pipeline_thread, shm);
     pthread_create(&state.threads[4], NULL, watchdog_thread, shm);
-    pthread_create(&state.threads[5], NULL, frame_sender_thread, &state);
-    pthread_create(&state.threads[6], NULL, video_streamer_thread, &state);
     
     sleep(2);
     
     printf("[Server] All threads started\n");
-    printf("[Server] Streaming to %s on 3 ports\n", CLIENT_IP);
+    printf("[Server] Streaming to %d fixed target%s and any client subscribing on port %d\n",
+           target_count, target_count == 1 ? "" : "s", UDP_SERVER_PORT);
     printf("[Server] Press Ctrl+C to stop...\n\n");
     
     while (shm->system_active) {
@@ -58,7 +136,7 @@ int main() {
     printf("\n[Server] Shutting down...\n");
     shm->system_active = false;
     
-    for (int i = 0; i < 7; i++) {
+    for (int i = 0; i < 5; i++) {
         pthread_join(state.threads[i], NULL);
     }
     
@@ -0,0 +1,187 @@
+#include "../include/aviation_system.h"
+
+// Stream pacing shared by every sender. Frame n of every stream is due at
+// epoch + (n - 1) / FPS. The epoch is set by the first stream to start, so
+// all streams run off one absolute CLOCK_MONOTONIC schedule: time spent
+// sending does not stretch the period, and the streams cannot drift apart.
+// A per-stream token bucket caps burst size and average bitrate. Lateness
+// of every frame against its deadline, and its jitter, is recorded.
+//
+// The frame stream is also the server's frame clock: publishing a frame
+// ticks it (frame_clock_tick), and the threads that act per frame block on
+// the tick (frame_clock_wait) instead of polling current_frame, recording
+// how far behind the stream they run and any frames they missed.
+
+static pthread_once_t epoch_once = PTHREAD_ONCE_INIT;
+static struct timespec pacing_epoch;
+
+static void init_pacing_epoch() {
+    clock_gettime(CLOCK_MONOTONIC, &pacing_epoch);
+}
+
+static double seconds_between(const struct timespec* start, const struct timespec* end) {
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void add_nanoseconds(struct timespec* t, long long nanoseconds) {
+    t->tv_sec += nanoseconds / 1000000000LL;
+    t->tv_nsec += nanoseconds % 1000000000LL;
+    if (t->tv_nsec >= 1000000000L) {
+        t->tv_nsec -= 1000000000L;
+        t->tv_sec++;
+    }
+}
+
+void token_bucket_init(TokenBucket* bucket, double bytes_per_second, double burst_bytes) {
+    bucket->rate = bytes_per_second;
+    bucket->burst = burst_bytes;
+    bucket->tokens = burst_bytes;
+    bucket->wait_seconds = 0;
+    clock_gettime(CLOCK_MONOTONIC, &bucket->last_refill);
+}
+
+static void token_bucket_refill(TokenBucket* bucket) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    bucket->tokens += bucket->rate * seconds_between(&bucket->last_refill, &now);
+    if (bucket->tokens > bucket->burst) bucket->tokens = bucket->burst;
+    bucket->last_refill = now;
+}
+
+// Blocks until `bytes` may be sent, then takes them from the bucket. A send
+// larger than the bucket waits for a full bucket and leaves it in debt, so
+// the average rate still holds.
+void token_bucket_consume(TokenBucket* bucket, size_t bytes) {
+    if (bucket->rate <= 0) return;
+
+    double needed = (double)bytes < bucket->burst ? (double)bytes : bucket->burst;
+    token_bucket_refill(bucket);
+    if (bucket->tokens < needed) {
+        double wait = (needed - bucket->tokens) / bucket->rate;
+        struct timespec until = bucket->last_refill;
+        add_nanoseconds(&until, (long long)(wait * 1e9));
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL);
+        bucket->wait_seconds += wait;
+        token_bucket_refill(bucket);
+    }
+    bucket->tokens -= bytes;
+}
+
+// fps <= 0 gives an unscheduled pacer (live mode: frames arrive in real
+// time), which only applies the token bucket.
+void pacer_init(StreamPacer* pacer, const char* name, int fps,
+                double bytes_per_second, double burst_bytes) {
+    pthread_once(&epoch_once, init_pacing_epoch);
+    memset(pacer, 0, sizeof(*pacer));
+    pacer->name = name;
+    pacer->period_ns = fps > 0 ? 1000000000L / fps : 0;
+    token_bucket_init(&pacer->bucket, bytes_per_second, burst_bytes);
+}
+
+static struct timespec pacer_deadline(const StreamPacer* pacer, int frame_number) {
+    struct timespec deadline = pacing_epoch;
+    add_nanoseconds(&deadline, (long long)(frame_number - 1) * pacer->period_ns);
+    return deadline;
+}
+
+// Sleeps until frame_number is due (returns at once if it is already late)
+void pacer_wait_frame(StreamPacer* pacer, int frame_number) {
+    if (pacer->period_ns == 0) return;
+    struct timespec deadline = pacer_deadline(pacer, frame_number);
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+}
+
+// Time left until frame_number is due; <= 0 once due (always 0 unscheduled)
+long long pacer_ns_until_frame(const StreamPacer* pacer, int frame_number) {
+    if (pacer->period_ns == 0) return 0;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    struct timespec deadline = pacer_deadline(pacer, frame_number);
+    return (long long)(deadline.tv_sec - now.tv_sec) * 1000000000LL +
+           (deadline.tv_nsec - now.tv_nsec);
+}
+
+// Records how late frame_number went out against its deadline
+void pacer_frame_sent(StreamPacer* pacer, int frame_number) {
+    pacer->frames++;
+    if (pacer->period_ns == 0) return;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    struct timespec deadline = pacer_deadline(pacer, frame_number);
+    double late = seconds_between(&deadline, &now);
+    if (late < 0) late = 0;
+
+    pacer->late_total += late;
+    if (late > pacer->late_max) pacer->late_max = late;
+    if (late * 1000.0 > PACE_LATE_THRESHOLD_MS) pacer->late_frames++;
+    
+    // Interarrival jitter as RTP computes it (RFC 3550 6.4.1)
+    if (pacer->frames > 1) {
+        double change = late > pacer->late_last ? late - pacer->late_last : pacer->late_last - late;
+        pacer->jitter += (change - pacer->jitter) / 16.0;
+    }
+    pacer->late_last = late;
+}
+
+void pacer_report(const StreamPacer* pacer) {
+    if (pacer->frames == 0) return;
+    if (pacer->period_ns == 0) {
+        printf("[Pacer] %s: %ld frames (unscheduled) | bucket waits %.1f ms\n",
+               pacer->name, pacer->frames, pacer->bucket.wait_seconds * 1000.0);
+        return;
+    }
+    printf("[Pacer] %s: %ld frames | late avg %.2f ms, max %.2f ms | jitter %.2f ms | "
+           "%ld over %d ms | bucket waits %.1f ms\n",
+           pacer->name, pacer->frames, pacer->late_total * 1000.0 / pacer->frames,
+           pacer->late_max * 1000.0, pacer->jitter * 1000.0, pacer->late_frames,
+           PACE_LATE_THRESHOLD_MS, pacer->bucket.wait_seconds * 1000.0);
+}
+
+// Stamps the tick and wakes every follower. Call with frame_mutex held,
+// after setting current_frame.
+void frame_clock_tick(SharedMemory* shm) {
+    shm->frame_tick_ns = wire_now_ns();
+    pthread_cond_broadcast(&shm->frame_tick_cond);
+}
+
+void tick_follower_init(TickFollower* follower, const char* name) {
+    memset(follower, 0, sizeof(*follower));
+    follower->name = name;
+}
+
+// Waits up to timeout_ms for a frame newer than the follower's last one and
+// returns the current frame (unchanged on timeout, so the caller can check
+// system_active). frame_tick_cond waits on CLOCK_MONOTONIC.
+int frame_clock_wait(SharedMemory* shm, TickFollower* follower, int timeout_ms) {
+    struct timespec until;
+    clock_gettime(CLOCK_MONOTONIC, &until);
+    add_nanoseconds(&until, timeout_ms * 1000000LL);
+    
+    pthread_mutex_lock(&shm->frame_mutex);
+    while (shm->current_frame == follower->frame && shm->system_active) {
+        if (pthread_cond_timedwait(&shm->frame_tick_cond, &shm->frame_mutex, &until) != 0) break;
+    }
+    int frame = shm->current_frame;
+    uint64_t tick_ns = shm->frame_tick_ns;
+    pthread_mutex_unlock(&shm->frame_mutex);
+    
+    if (frame != follower->frame && frame > 0 && tick_ns != 0) {
+        double lag = (wire_now_ns() - tick_ns) / 1e9;
+        follower->ticks++;
+        follower->lag_total += lag;
+        if (lag > follower->lag_max) follower->lag_max = lag;
+        if (follower->frame > 0 && frame > follower->frame + 1) {
+            follower->skipped += frame - follower->frame - 1;
+        }
+    }
+    follower->frame = frame;
+    return frame;
+}
+
+void tick_follower_report(const TickFollower* follower) {
+    if (follower->ticks == 0) return;
+    printf("[Pacer] %s: %ld ticks | behind the stream avg %.2f ms, max %.2f ms | %ld frames missed\n",
+           follower->name, follower->ticks, follower->lag_total * 1000.0 / follower->ticks,
+           follower->lag_max * 1000.0, follower->skipped);
+}
@@ -0,0 +1,115 @@
+#include "../include/aviation_system.h"
+#include <math.h>
+
+// Bitrate adaptation of the stream. Receivers REPORT every
+// WIRE_REPORT_INTERVAL_MS what reached them; the budget follows the worst
+// of them: a report with more than ADAPT_LOSS_HIGH loss cuts it to
+// ADAPT_DECREASE of the rate that receiver actually got, and it only grows
+// again (by ADAPT_INCREASE per interval) while every report stays under
+// ADAPT_LOSS_LOW and no cut happened for ADAPT_HOLD_MS. Each frame is then
+// sent at the best level of the ADAPT_QUALITIES / ADAPT_SCALES ladder whose
+// average encoded size fits the budget. Only the frame sender thread
+// touches the controller, so there is no lock.
+
+// Assumed size of a level's frames next to the level above, until one is seen
+#define LEVEL_SIZE_RATIO 0.7
+// Stepping up needs this much room, so size swings between frames do not
+// bounce the level straight back
+#define STEP_UP_MARGIN 0.85
+
+static const int level_qualities[ADAPT_LEVELS] = ADAPT_QUALITIES;
+static const int level_scales[ADAPT_LEVELS] = ADAPT_SCALES;
+
+void rate_controller_init(RateController* rate, double max_budget) {
+    memset(rate, 0, sizeof(*rate));
+    rate->budget = max_budget;
+    rate->max_budget = max_budget;
+    rate->level = ADAPT_START_LEVEL;
+}
+
+void rate_controller_report(RateController* rate, const WireReport* report,
+                            const struct sockaddr_in* from, uint64_t now_ns) {
+    uint32_t expected = report->messages + report->lost;
+    if (expected == 0) return;      // Nothing was streamed to it
+    rate->reports++;
+
+    double loss = (double)report->lost / expected;
+    if (loss > rate->window_loss) rate->window_loss = loss;
+
+    if (loss > ADAPT_LOSS_HIGH) {
+        // What got through is an upper bound on what this path carries
+        double received = report->bytes * 1000.0 / report->interval_ms;
+        double cut = received * ADAPT_DECREASE;
+        if (cut < ADAPT_MIN_RATE) cut = ADAPT_MIN_RATE;
+        if (cut < rate->budget) {
+            char host[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &from->sin_addr, host, sizeof(host));
+            printf("[RateControl] %s:%d lost %.1f%%, budget %.0f -> %.0f KB/s\n",
+                   host, ntohs(from->sin_port), loss * 100.0, rate->budget / 1024.0, cut / 1024.0);
+            rate->budget = cut;
+            rate->cuts++;
+        }
+        rate->last_cut_ns = now_ns;
+        return;
+    }
+
+    // Growth is decided once per interval, on the worst loss reported in it
+    if (now_ns - rate->last_growth_ns < WIRE_REPORT_INTERVAL_MS * 1000000ULL) return;
+    if (rate->window_loss < ADAPT_LOSS_LOW &&
+        now_ns - rate->last_cut_ns >= ADAPT_HOLD_MS * 1000000ULL) {
+        rate->budget *= ADAPT_INCREASE;
+        if (rate->budget > rate->max_budget) rate->budget = rate->max_budget;
+    }
+    rate->window_loss = 0;
+    rate->last_growth_ns = now_ns;
+}
+
+// Average encoded size of a level's frames; levels not used yet are guessed
+// from the nearest one that was
+static double level_frame_bytes(const RateController* rate, int level) {
+    if (rate->frame_bytes[level] > 0) return rate->frame_bytes[level];
+    for (int distance = 1; distance < ADAPT_LEVELS; distance++) {
+        int better = level - distance;
+        int worse = level + distance;
+        if (better >= 0 && rate->frame_bytes[better] > 0) {
+            return rate->frame_bytes[better] * pow(LEVEL_SIZE_RATIO, distance);
+        }
+        if (worse < ADAPT_LEVELS && rate->frame_bytes[worse] > 0) {
+            return rate->frame_bytes[worse] / pow(LEVEL_SIZE_RATIO, distance);
+        }
+    }
+    return 0;
+}
+
+// Level for the next frame of a stream running at fps
+int rate_controller_level(RateController* rate, int fps, uint64_t now_ns) {
+    double frame_budget = rate->budget * ADAPT_HEADROOM / fps;
+    int level = rate->level;
+    while (level < ADAPT_LEVELS - 1 && level_frame_bytes(rate, level) > frame_budget) level++;
+    if (level == rate->level && level > 0 &&
+        now_ns - rate->last_cut_ns >= ADAPT_HOLD_MS * 1000000ULL &&
+        level_frame_bytes(rate, level - 1) <= frame_budget * STEP_UP_MARGIN) {
+        level--;
+    }
+
+    if (level != rate->level) {
+        printf("[RateControl] Level %d -> %d (quality %d, %d%% size) for %.0f KB/s\n",
+               rate->level, level, level_qualities[level], level_scales[level],
+               rate->budget / 1024.0);
+        rate->level = level;
+        rate->level_changes++;
+    }
+    return level;
+}
+
+void rate_controller_frame_sent(RateController* rate, int level, uint32_t length) {
+    double* average = &rate->frame_bytes[level];
+    *average = *average > 0 ? 0.8 * *average + 0.2 * length : length;
+}
+
+void print_rate_stats(const char* label, const RateController* rate) {
+    printf("%s Rate control: %ld reports (%ld from non-subscribers ignored) | "
+           "%ld budget cuts | %ld level changes | now level %d at %.0f KB/s\n",
+           label, rate->reports, rate->reports_refused, rate->cuts, rate->level_changes,
+           rate->level, rate->budget / 1024.0);
+}
@@ -6,22 +6,24 @@ void* sensor_data_thread(void* arg) {
     
     printf("[SensorThread] Started - Monitoring current frame\n");
     
+    TickFollower clock;
+    tick_follower_init(&clock, "sensor");
+    
     while (shm->system_active) {
-        pthread_mutex_lock(&shm->frame_mutex);
-        int current = shm->current_frame;
-        pthread_mutex_unlock(&shm->frame_mutex);
+        // Follows the frame clock: the reading changes as the frame does
+        int current = frame_clock_wait(shm, &clock, FRAME_TICK_TIMEOUT_MS);
         
         // Update current sensor reading based on frame number
         if (current >= 0 && current < TOTAL_FRAMES) {
             pthread_mutex_lock(&shm->sensor_mutex);
             shm->current_sensor = shm->frame_sensors[current];
             shm->current_sensor.timestamp = time(NULL);
+            shm->current_sensor.time_ns = wire_realtime_ns();
             pthread_mutex_unlock(&shm->sensor_mutex);
         }
-        
-        usleep(100000);  // Check every 100ms
     }
     
+    tick_follower_report(&clock);
     printf("[SensorThread] Stopped\n");
     return NULL;
 }
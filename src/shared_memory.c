@@ -44,6 +44,8 @@ SharedMemory* init_shared_memory() {
     pthread_condattr_init(&cond_attr);
     pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
     pthread_cond_init(&shm->ui_update_cond, &cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);    // Frame clock deadlines
+    pthread_cond_init(&shm->frame_tick_cond, &cond_attr);
     pthread_condattr_destroy(&cond_attr);
 
     sem_unlink(SEM_FRAME_READY);
@@ -60,6 +62,7 @@ SharedMemory* init_shared_memory() {
     shm->system_active = true;
     shm->frames_extracted = false;
     shm->current_frame = 0;
+    shm->frame_tick_ns = 0;
     shm->total_frames_processed = 0;
     shm->frame_ready_for_processing = false;
     shm->processing_complete = false;
@@ -94,6 +97,7 @@ void initialize_sensor_data(SharedMemory* shm) {
         shm->frame_sensors[i].longitude = 77.2000 + (i * 0.0001);
         
         shm->frame_sensors[i].timestamp = time(NULL);
+        shm->frame_sensors[i].time_ns = wire_realtime_ns();
         shm->frame_sensors[i].is_valid = true;
     }
     
@@ -114,6 +118,7 @@ void cleanup_shared_memory(SharedMemory* shm) {
         pthread_mutex_destroy(&shm->ui_mutex);
         pthread_barrier_destroy(&shm->processing_barrier);
         pthread_cond_destroy(&shm->ui_update_cond);
+        pthread_cond_destroy(&shm->frame_tick_cond);
 
         sem_close(shm->sem_frame_ready);
         sem_close(shm->sem_processing_done);
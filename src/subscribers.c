@@ -0,0 +1,174 @@
+#include "../include/aviation_system.h"
+#include <sys/random.h>
+
+// Where the stream goes. Clients join by sending SUBSCRIBE to the server's
+// socket and stay for WIRE_SUBSCRIBE_LEASE_MS after each renewal; fixed
+// targets (--client, --multicast) never expire. Only the frame sender
+// thread touches the registry (it also reads the socket the SUBSCRIBE
+// messages arrive on), so there is no lock.
+
+void subscriber_registry_init(SubscriberRegistry* registry) {
+    memset(registry, 0, sizeof(*registry));
+    if (getrandom(registry->cookie_key, sizeof(registry->cookie_key), 0) !=
+        (ssize_t)sizeof(registry->cookie_key)) {
+        // No entropy source: weaker, but still not a constant
+        registry->cookie_key[0] = wire_realtime_ns();
+        registry->cookie_key[1] = wire_now_ns() ^ ((uint64_t)getpid() << 32);
+    }
+}
+
+// SUBSCRIBE cookies: SipHash-2-4 of the address and the cookie epoch under
+// the registry's key. Only whoever receives at an address sees its cookie,
+// and one address's cookie tells nothing about another's.
+#define SIP_ROTATE(x, b) (((x) << (b)) | ((x) >> (64 - (b))))
+
+static void sip_rounds(uint64_t v[4], int rounds) {
+    for (int r = 0; r < rounds; r++) {
+        v[0] += v[1]; v[1] = SIP_ROTATE(v[1], 13); v[1] ^= v[0]; v[0] = SIP_ROTATE(v[0], 32);
+        v[2] += v[3]; v[3] = SIP_ROTATE(v[3], 16); v[3] ^= v[2];
+        v[0] += v[3]; v[3] = SIP_ROTATE(v[3], 21); v[3] ^= v[0];
+        v[2] += v[1]; v[1] = SIP_ROTATE(v[1], 17); v[1] ^= v[2]; v[2] = SIP_ROTATE(v[2], 32);
+    }
+}
+
+static uint64_t cookie_for_epoch(const SubscriberRegistry* registry,
+                                 const struct sockaddr_in* addr, uint64_t epoch) {
+    const uint64_t* key = registry->cookie_key;
+    uint64_t v[4] = { key[0] ^ 0x736f6d6570736575ULL, key[1] ^ 0x646f72616e646f6dULL,
+                      key[0] ^ 0x6c7967656e657261ULL, key[1] ^ 0x7465646279746573ULL };
+    uint64_t words[3] = { ((uint64_t)addr->sin_addr.s_addr << 16) | addr->sin_port, epoch,
+                          16ULL << 56 };    // Last word: the message length
+    for (int i = 0; i < 3; i++) {
+        v[3] ^= words[i];
+        sip_rounds(v, 2);
+        v[0] ^= words[i];
+    }
+    v[2] ^= 0xff;
+    sip_rounds(v, 4);
+    uint64_t cookie = v[0] ^ v[1] ^ v[2] ^ v[3];
+    return cookie ? cookie : 1;             // 0 means "no cookie yet"
+}
+
+// The cookie to hand addr now
+uint64_t subscriber_cookie(const SubscriberRegistry* registry, const struct sockaddr_in* addr,
+                           uint64_t now_ns) {
+    return cookie_for_epoch(registry, addr, now_ns / (SUBSCRIBE_COOKIE_EPOCH_MS * 1000000ULL));
+}
+
+// Whether addr's SUBSCRIBE echoes a cookie handed to it in this epoch or
+// the last, so a client renewing across an epoch change is not turned away
+bool subscriber_cookie_valid(const SubscriberRegistry* registry, const struct sockaddr_in* addr,
+                             uint64_t cookie, uint64_t now_ns) {
+    uint64_t epoch = now_ns / (SUBSCRIBE_COOKIE_EPOCH_MS * 1000000ULL);
+    return cookie != 0 && (cookie == cookie_for_epoch(registry, addr, epoch) ||
+                           (epoch > 0 && cookie == cookie_for_epoch(registry, addr, epoch - 1)));
+}
+
+static int subscriber_find(const SubscriberRegistry* registry, const struct sockaddr_in* addr) {
+    for (int i = 0; i < registry->count; i++) {
+        const struct sockaddr_in* entry = &registry->entries[i].addr;
+        if (entry->sin_addr.s_addr == addr->sin_addr.s_addr && entry->sin_port == addr->sin_port) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Adds addr, or renews its lease. expires_ns = 0 makes it a fixed target.
+// Returns 1 for a new subscriber, 0 for a renewal, -1 if the registry is full.
+int subscriber_join(SubscriberRegistry* registry, const struct sockaddr_in* addr,
+                    uint64_t expires_ns) {
+    int i = subscriber_find(registry, addr);
+    if (i >= 0) {
+        // A fixed target stays fixed
+        if (registry->entries[i].expires_ns != 0) registry->entries[i].expires_ns = expires_ns;
+        return 0;
+    }
+    if (registry->count == MAX_SUBSCRIBERS) return -1;
+
+    Subscriber* entry = &registry->entries[registry->count++];
+    memset(entry, 0, sizeof(*entry));
+    entry->addr = *addr;
+    entry->expires_ns = expires_ns;
+    registry->joined++;
+    return 1;
+}
+
+// The entry for addr, or NULL if it is not subscribed. Clients' NACKs and
+// REPORTs are only acted on when this finds them: a forged source address
+// must not draw resends or steer the encoder.
+Subscriber* subscriber_lookup(SubscriberRegistry* registry, const struct sockaddr_in* addr) {
+    int i = subscriber_find(registry, addr);
+    return i >= 0 ? &registry->entries[i] : NULL;
+}
+
+// The fixed multicast target `from` may be a receiver of, or NULL. Group
+// receivers never SUBSCRIBE, and one cannot be told from anyone else in
+// the group's scope (the local link at MULTICAST_TTL 1) sending from the
+// group's port; so their NACKs and REPORTs are taken as the group's.
+Subscriber* subscriber_group_for(SubscriberRegistry* registry, const struct sockaddr_in* from) {
+    for (int i = 0; i < registry->count; i++) {
+        Subscriber* entry = &registry->entries[i];
+        if (entry->expires_ns == 0 && IN_MULTICAST(ntohl(entry->addr.sin_addr.s_addr)) &&
+            entry->addr.sin_port == from->sin_port) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void subscriber_remove_at(SubscriberRegistry* registry, int i) {
+    registry->entries[i] = registry->entries[--registry->count];
+}
+
+bool subscriber_leave(SubscriberRegistry* registry, const struct sockaddr_in* addr) {
+    int i = subscriber_find(registry, addr);
+    if (i < 0) return false;
+    subscriber_remove_at(registry, i);
+    registry->left++;
+    return true;
+}
+
+// Drops every subscriber whose lease ran out, or whose last
+// SUBSCRIBER_MAX_SEND_FAILURES sends were all refused (it can subscribe
+// again once it is reachable; fixed targets stay). Returns how many.
+int subscriber_expire(SubscriberRegistry* registry, uint64_t now_ns) {
+    int expired = 0;
+    for (int i = registry->count - 1; i >= 0; i--) {
+        const Subscriber* entry = &registry->entries[i];
+        bool timed_out = entry->expires_ns != 0 && entry->expires_ns <= now_ns;
+        bool unreachable = entry->expires_ns != 0 &&
+                           entry->send_failures >= SUBSCRIBER_MAX_SEND_FAILURES;
+        if (timed_out || unreachable) {
+            char host[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &entry->addr.sin_addr, host, sizeof(host));
+            printf("[Subscribers] %s:%d %s\n", host, ntohs(entry->addr.sin_port),
+                   timed_out ? "timed out" : "unreachable, dropped");
+            if (timed_out) registry->expired++;
+            else registry->evicted++;
+            subscriber_remove_at(registry, i);
+            expired++;
+        }
+    }
+    return expired;
+}
+
+// Parses "IP" or "IP:PORT" (default_port if none) into *addr
+bool parse_stream_target(const char* text, int default_port, struct sockaddr_in* addr) {
+    char host[INET_ADDRSTRLEN];
+    int port = default_port;
+    const char* colon = strchr(text, ':');
+    size_t host_length = colon ? (size_t)(colon - text) : strlen(text);
+    if (host_length == 0 || host_length >= sizeof(host)) return false;
+    memcpy(host, text, host_length);
+    host[host_length] = '\0';
+    if (colon) {
+        port = atoi(colon + 1);
+        if (port <= 0 || port > 65535) return false;
+    }
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_port = htons((uint16_t)port);
+    return inet_pton(AF_INET, host, &addr->sin_addr) == 1;
+}
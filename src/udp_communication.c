@@ -7,22 +7,25 @@ int init_udp_socket() {
         return -1;
     }
     
-    printf("[UDP-Server] Socket created successfully\n");
-    printf("[UDP-Server] Target client: %s:%d\n", CLIENT_IP, UDP_PORT);
-    return sock;
-}
-
-void send_video_packet_udp(int socket_fd, VideoPacket* packet) {
-    struct sockaddr_in dest_addr;
-    dest_addr.sin_family = AF_INET;
-    dest_addr.sin_port = htons(UDP_PORT);
-    dest_addr.sin_addr.s_addr = inet_addr(CLIENT_IP);
+    // Clients SUBSCRIBE and NACK to a known port; the stream leaves from it too
+    int reuse = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(UDP_SERVER_PORT);
+    if (bind(sock, (struct sockaddr*)&local, sizeof(local)) < 0) {
+        perror("[UDP-Server] Bind failed");
+        close(sock);
+        return -1;
+    }
     
-    ssize_t sent = sendto(socket_fd, packet, sizeof(VideoPacket), 0,
-                          (struct sockaddr*)&dest_addr, sizeof(dest_addr));
+    // Multicast targets stay on the local network unless MULTICAST_TTL says otherwise
+    unsigned char ttl = MULTICAST_TTL;
+    setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
     
-    if (sent < 0) {
-        perror("[UDP-Server] Send failed");
-    }
+    printf("[UDP-Server] Socket created successfully\n");
+    printf("[UDP-Server] Listening for subscribers on port %d\n", UDP_SERVER_PORT);
+    return sock;
 }
-
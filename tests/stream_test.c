@@ -0,0 +1,471 @@
+#include "../include/aviation_system.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <math.h>
+
+// Checks of the stream protocol that need neither OpenCV nor a display:
+// the wire codecs, FEC repair, NACK timing, the frame timeout and, over
+// loopback, a StreamSender answering a NACK. Run with `make test`; exits
+// non-zero if any check fails.
+//
+// Reassembler time is passed in, so the timing checks step a fake clock
+// instead of sleeping.
+
+#define MS 1000000ULL
+#define TEST_CHUNK_SIZE 1000
+#define TEST_FEC_GROUP 4
+
+static int checks;
+static int failures;
+
+#define CHECK(cond) check((cond), #cond, __LINE__)
+
+static void check(bool ok, const char* what, int line) {
+    checks++;
+    if (!ok) {
+        failures++;
+        printf("[Test] ✗ line %d: %s\n", line, what);
+    }
+}
+
+static void passed(const char* name, int failures_before) {
+    if (failures == failures_before) printf("[Test] ✓ %s\n", name);
+}
+
+static void fill_frame(uint8_t* frame, uint32_t length, uint32_t seed) {
+    for (uint32_t i = 0; i < length; i++) frame[i] = (uint8_t)(i * 31 + seed);
+}
+
+// Every datagram of one frame as the sender builds them: data chunks, each
+// group of TEST_FEC_GROUP followed by its parity chunk. Returns the count.
+static int build_chunks(uint32_t frame_id, const uint8_t* frame, uint32_t length,
+                        uint8_t datagrams[][WIRE_CHUNK_HEADER_SIZE + TEST_CHUNK_SIZE],
+                        size_t* lengths) {
+    WireChunkHeader chunk;
+    memset(&chunk, 0, sizeof(chunk));
+    chunk.header.frame_id = frame_id;
+    chunk.frame_length = length;
+    chunk.chunk_size = TEST_CHUNK_SIZE;
+    chunk.total_chunks = wire_chunk_count(length, TEST_CHUNK_SIZE);
+    chunk.fec_group = TEST_FEC_GROUP;
+
+    int count = 0;
+    for (int first = 0; first < chunk.total_chunks; first += TEST_FEC_GROUP) {
+        uint8_t xor_sum[TEST_CHUNK_SIZE];
+        memset(xor_sum, 0, sizeof(xor_sum));
+        int last = first + TEST_FEC_GROUP;
+        if (last > chunk.total_chunks) last = chunk.total_chunks;
+        for (int c = first; c < last; c++) {
+            chunk.flags = 0;
+            chunk.chunk_id = (uint16_t)c;
+            chunk.payload_length = (uint16_t)wire_chunk_length(length, TEST_CHUNK_SIZE, c);
+            wire_chunk_header_encode(&chunk, datagrams[count]);
+            memcpy(datagrams[count] + WIRE_CHUNK_HEADER_SIZE,
+                   frame + (size_t)c * TEST_CHUNK_SIZE, chunk.payload_length);
+            wire_xor(xor_sum, frame + (size_t)c * TEST_CHUNK_SIZE, chunk.payload_length);
+            lengths[count++] = WIRE_CHUNK_HEADER_SIZE + chunk.payload_length;
+        }
+        chunk.flags = WIRE_CHUNK_PARITY;
+        chunk.chunk_id = (uint16_t)(first / TEST_FEC_GROUP);
+        chunk.payload_length = (uint16_t)wire_chunk_length(length, TEST_CHUNK_SIZE, first);
+        wire_chunk_header_encode(&chunk, datagrams[count]);
+        memcpy(datagrams[count] + WIRE_CHUNK_HEADER_SIZE, xor_sum, chunk.payload_length);
+        lengths[count++] = WIRE_CHUNK_HEADER_SIZE + chunk.payload_length;
+    }
+    return count;
+}
+
+// 10 data chunks (the last one short) and 3 parity chunks
+#define TEST_FRAME_BYTES (9 * TEST_CHUNK_SIZE + 321)
+#define TEST_DATAGRAMS 13
+
+static uint8_t datagrams[TEST_DATAGRAMS][WIRE_CHUNK_HEADER_SIZE + TEST_CHUNK_SIZE];
+static size_t lengths[TEST_DATAGRAMS];
+
+static void test_codecs(void) {
+    int before = failures;
+    uint8_t out[WIRE_NACK_MAX_SIZE];
+
+    WireMeta meta, meta_in;
+    memset(&meta, 0, sizeof(meta));
+    meta.header.frame_id = 42;
+    meta.header.sequence = 7;
+    meta.header.timestamp_ns = 123456789012345ULL;
+    meta.header.source_id = 3;
+    meta.width = 320;
+    meta.height = 240;
+    meta.telemetry.flags = WIRE_TELEMETRY_VALID;
+    meta.telemetry.sequence = 41;
+    meta.telemetry.time_ns = 987654321ULL;
+    meta.telemetry.latitude = 40.6413111;
+    meta.telemetry.longitude = -73.7781391;
+    meta.telemetry.altitude = 1234.56;
+    meta.telemetry.speed = 250.3;
+    meta.capture_ns = 11;
+    meta.encode_ns = 22;
+    size_t length = wire_meta_encode(&meta, out);
+    CHECK(length == WIRE_META_SIZE);
+    CHECK(wire_meta_decode(out, length, &meta_in));
+    CHECK(meta_in.header.frame_id == 42 && meta_in.header.sequence == 7);
+    CHECK(meta_in.header.timestamp_ns == meta.header.timestamp_ns);
+    CHECK(meta_in.header.source_id == 3);
+    CHECK(meta_in.width == 320 && meta_in.height == 240);
+    CHECK(meta_in.telemetry.sequence == 41 && meta_in.telemetry.time_ns == 987654321ULL);
+    CHECK(fabs(meta_in.telemetry.latitude - meta.telemetry.latitude) < 1e-7);
+    CHECK(fabs(meta_in.telemetry.longitude - meta.telemetry.longitude) < 1e-7);
+    CHECK(fabs(meta_in.telemetry.altitude - meta.telemetry.altitude) < 0.01);
+    CHECK(fabs(meta_in.telemetry.speed - meta.telemetry.speed) < 0.1);
+    CHECK(meta_in.capture_ns == 11 && meta_in.encode_ns == 22);
+    CHECK(!wire_meta_decode(out, length - 1, &meta_in));
+
+    // Out-of-range readings are clamped, not wrapped
+    WireTelemetry telemetry, telemetry_in;
+    memset(&telemetry, 0, sizeof(telemetry));
+    telemetry.speed = -5.0;
+    telemetry.altitude = 1e12;
+    uint8_t record[WIRE_TELEMETRY_SIZE];
+    wire_telemetry_encode(&telemetry, record);
+    wire_telemetry_decode(record, &telemetry_in);
+    CHECK(telemetry_in.speed == 0.0);
+    CHECK(telemetry_in.altitude == INT32_MAX / WIRE_ALTITUDE_UNITS);
+
+    WireAlert alert, alert_in;
+    memset(&alert, 0, sizeof(alert));
+    alert.header.frame_id = 90;
+    alert.confidence = 0.875;
+    memset(alert.type, 'x', sizeof(alert.type));    // Not terminated: cut on encode
+    length = wire_alert_encode(&alert, out);
+    CHECK(length == WIRE_ALERT_SIZE);
+    CHECK(wire_alert_decode(out, length, &alert_in));
+    CHECK(alert_in.confidence == 0.875);
+    CHECK(strlen(alert_in.type) == WIRE_ALERT_TYPE_BYTES - 1);
+    CHECK(!wire_meta_decode(out, length, &meta_in));
+
+    WireNack nack, nack_in;
+    memset(&nack, 0, sizeof(nack));
+    nack.header.frame_id = 5;
+    nack.first_chunk = 3;
+    nack.chunk_count = 11;
+    nack.missing[0] = 0x81;
+    nack.missing[1] = 0x04;
+    length = wire_nack_encode(&nack, out);
+    CHECK(length == WIRE_NACK_HEADER_SIZE + 2);
+    CHECK(wire_nack_decode(out, length, &nack_in));
+    CHECK(nack_in.first_chunk == 3 && nack_in.chunk_count == 11);
+    CHECK(wire_nack_missing(&nack_in, 0) && wire_nack_missing(&nack_in, 7));
+    CHECK(wire_nack_missing(&nack_in, 10) && !wire_nack_missing(&nack_in, 1));
+    CHECK(!wire_nack_decode(out, length + 1, &nack_in));
+    nack.chunk_count = 0;
+    length = wire_nack_encode(&nack, out);
+    CHECK(!wire_nack_decode(out, length, &nack_in));
+
+    WireSubscribe subscribe, subscribe_in;
+    memset(&subscribe, 0, sizeof(subscribe));
+    subscribe.flags = WIRE_SUBSCRIBE_LEAVE;
+    subscribe.cookie = 0x0123456789abcdefULL;
+    length = wire_subscribe_encode(&subscribe, out);
+    CHECK(length == WIRE_SUBSCRIBE_SIZE);
+    CHECK(wire_subscribe_decode(out, length, &subscribe_in));
+    CHECK(subscribe_in.flags == WIRE_SUBSCRIBE_LEAVE && subscribe_in.cookie == subscribe.cookie);
+
+    WireCookie cookie, cookie_in;
+    memset(&cookie, 0, sizeof(cookie));
+    cookie.cookie = 0xfedcba9876543210ULL;
+    length = wire_cookie_encode(&cookie, out);
+    CHECK(wire_cookie_decode(out, length, &cookie_in) && cookie_in.cookie == cookie.cookie);
+    CHECK(!wire_subscribe_decode(out, length, &subscribe_in));
+
+    WireReport report, report_in;
+    memset(&report, 0, sizeof(report));
+    report.interval_ms = 500;
+    report.messages = 1000;
+    report.lost = 12;
+    report.bytes = 1234567;
+    length = wire_report_encode(&report, out);
+    CHECK(wire_report_decode(out, length, &report_in));
+    CHECK(report_in.messages == 1000 && report_in.lost == 12 && report_in.bytes == 1234567);
+    report.interval_ms = 0;
+    wire_report_encode(&report, out);
+    CHECK(!wire_report_decode(out, length, &report_in));
+
+    WireTiles tiles, tiles_in;
+    memset(&tiles, 0, sizeof(tiles));
+    tiles.tile_size = TILE_SIZE;
+    tiles.columns = 10;
+    tiles.rows = 8;
+    tiles.reference = 77;
+    length = wire_tiles_encode(&tiles, out);
+    CHECK(!wire_tiles_decode(out, length, &tiles_in));      // Bitmap missing
+    CHECK(wire_tiles_decode(out, length + wire_tiles_bitmap_size(&tiles), &tiles_in));
+    CHECK(tiles_in.reference == 77 && wire_tiles_bitmap_size(&tiles_in) == 10);
+
+    // Wrong magic, version or kind is never taken for a message
+    WireHeader header;
+    wire_meta_encode(&meta, out);
+    CHECK(wire_header_decode(out, WIRE_META_SIZE, &header) && header.kind == WIRE_MSG_META);
+    out[2] = WIRE_VERSION + 1;
+    CHECK(!wire_header_decode(out, WIRE_META_SIZE, &header));
+    out[2] = WIRE_VERSION;
+    out[0] ^= 0xff;
+    CHECK(!wire_meta_decode(out, WIRE_META_SIZE, &meta_in));
+
+    // Chunks: the payload length must match what the frame layout implies
+    static uint8_t frame[TEST_FRAME_BYTES];
+    fill_frame(frame, TEST_FRAME_BYTES, 1);
+    int count = build_chunks(1, frame, TEST_FRAME_BYTES, datagrams, lengths);
+    CHECK(count == TEST_DATAGRAMS);
+    WireChunkHeader chunk;
+    CHECK(wire_chunk_header_decode(datagrams[0], lengths[0], &chunk));
+    CHECK(chunk.total_chunks == 10 && chunk.fec_group == TEST_FEC_GROUP);
+    CHECK(!wire_chunk_header_decode(datagrams[0], lengths[0] - 1, &chunk));
+    CHECK(wire_chunk_header_decode(datagrams[TEST_DATAGRAMS - 2], lengths[TEST_DATAGRAMS - 2],
+                                   &chunk));
+    CHECK(chunk.payload_length == 321);
+    passed("wire codecs round-trip and reject malformed messages", before);
+}
+
+static void test_fec(void) {
+    int before = failures;
+    WireReassembler reassembler;
+    CHECK(wire_reassembler_init(&reassembler));
+
+    static uint8_t frame[TEST_FRAME_BYTES];
+    fill_frame(frame, TEST_FRAME_BYTES, 2);
+    build_chunks(1, frame, TEST_FRAME_BYTES, datagrams, lengths);
+
+    // One data chunk lost in each group, the short last one included
+    const WireFrameSlot* done = NULL;
+    uint64_t now = 1000 * MS;
+    for (int i = 0; i < TEST_DATAGRAMS; i++) {
+        if (i == 1 || i == 7 || i == 11) continue;
+        const WireFrameSlot* slot = wire_reassembler_add(&reassembler, datagrams[i],
+                                                         lengths[i], now);
+        if (slot) done = slot;
+    }
+    CHECK(done != NULL);
+    CHECK(done && done->frame_length == TEST_FRAME_BYTES);
+    CHECK(done && memcmp(done->data, frame, TEST_FRAME_BYTES) == 0);
+    CHECK(reassembler.frames_repaired == 1 && reassembler.chunks_rebuilt == 3);
+
+    // A duplicate of a completed frame is not handed on twice
+    CHECK(wire_reassembler_add(&reassembler, datagrams[0], lengths[0], now) == NULL);
+    CHECK(reassembler.frames_completed == 1);
+    wire_reassembler_free(&reassembler);
+    passed("FEC rebuilds one lost chunk per group", before);
+}
+
+static void test_nack(void) {
+    int before = failures;
+    WireReassembler reassembler;
+    CHECK(wire_reassembler_init(&reassembler));
+
+    static uint8_t frame[TEST_FRAME_BYTES];
+    fill_frame(frame, TEST_FRAME_BYTES, 3);
+    build_chunks(2, frame, TEST_FRAME_BYTES, datagrams, lengths);
+
+    // Two lost in the second group: parity cannot cover them
+    uint64_t start = 1000 * MS;
+    for (int i = 0; i < TEST_DATAGRAMS; i++) {
+        if (i == 5 || i == 6) continue;
+        CHECK(wire_reassembler_add(&reassembler, datagrams[i], lengths[i], start) == NULL);
+    }
+
+    WireNack nack;
+    CHECK(!wire_reassembler_next_nack(&reassembler, start + (WIRE_NACK_DELAY_MS - 1) * MS,
+                                      &nack));
+    uint64_t asked = start + WIRE_NACK_DELAY_MS * MS;
+    CHECK(wire_reassembler_next_nack(&reassembler, asked, &nack));
+    CHECK(nack.header.frame_id == 2);
+    CHECK(nack.first_chunk == 4 && nack.chunk_count == 2);     // Data chunks 4 and 5
+    CHECK(wire_nack_missing(&nack, 0) && wire_nack_missing(&nack, 1));
+    CHECK(!wire_reassembler_next_nack(&reassembler, asked, &nack));
+    CHECK(!wire_reassembler_next_nack(&reassembler, asked + (WIRE_NACK_RETRY_MS - 1) * MS,
+                                      &nack));
+    CHECK(wire_reassembler_next_nack(&reassembler, asked + WIRE_NACK_RETRY_MS * MS, &nack));
+    CHECK(reassembler.nacks_sent == 2 && reassembler.chunks_requested == 4);
+
+    // One resent chunk is enough: parity rebuilds the other
+    const WireFrameSlot* done = wire_reassembler_add(&reassembler, datagrams[5], lengths[5],
+                                                     asked);
+    CHECK(done && memcmp(done->data, frame, TEST_FRAME_BYTES) == 0);
+    CHECK(reassembler.frames_nack_repaired == 1 && reassembler.frames_repaired == 1);
+    CHECK(wire_reassembler_add(&reassembler, datagrams[6], lengths[6], asked) == NULL);
+
+    // Past the repair deadline nothing more is asked for
+    build_chunks(3, frame, TEST_FRAME_BYTES, datagrams, lengths);
+    wire_reassembler_add(&reassembler, datagrams[0], lengths[0], start);
+    CHECK(!wire_reassembler_next_nack(&reassembler, start + WIRE_REPAIR_DEADLINE_MS * MS,
+                                      &nack));
+    CHECK(wire_reassembler_next_nack(&reassembler, start + (WIRE_REPAIR_DEADLINE_MS - 1) * MS,
+                                     &nack));
+    CHECK(nack.header.frame_id == 3);
+    wire_reassembler_free(&reassembler);
+    passed("NACKs wait, list the missing chunks, retry and stop at the deadline", before);
+}
+
+static void test_timeout(void) {
+    int before = failures;
+    WireReassembler reassembler;
+    CHECK(wire_reassembler_init(&reassembler));
+
+    static uint8_t frame[TEST_FRAME_BYTES];
+    fill_frame(frame, TEST_FRAME_BYTES, 4);
+    uint32_t frame_id = WIRE_REASSEMBLY_SLOTS + 5;
+    build_chunks(frame_id, frame, TEST_FRAME_BYTES, datagrams, lengths);
+
+    // Half the frame arrives, then nothing
+    uint64_t start = 1000 * MS;
+    for (int i = 0; i < 6; i++) {
+        wire_reassembler_add(&reassembler, datagrams[i], lengths[i], start);
+    }
+    uint64_t timeout = start + WIRE_FRAME_TIMEOUT_MS * MS;
+    CHECK(wire_reassembler_expire(&reassembler, timeout - 1) == 0);
+    CHECK(wire_reassembler_expire(&reassembler, timeout) == 1);
+    CHECK(reassembler.frames_timed_out == 1);
+    CHECK(wire_reassembler_expire(&reassembler, timeout + 1000 * MS) == 0);
+
+    // The rest straggles in: every chunk is ignored, the frame never completes
+    // and the slot is not restarted for it
+    int handed_on = 0;
+    for (int i = 0; i < TEST_DATAGRAMS; i++) {
+        if (wire_reassembler_add(&reassembler, datagrams[i], lengths[i], timeout + MS)) {
+            handed_on++;
+        }
+    }
+    const WireFrameSlot* slot = &reassembler.slots[frame_id % WIRE_REASSEMBLY_SLOTS];
+    CHECK(handed_on == 0);
+    CHECK(slot->frame_num == frame_id && slot->timed_out && slot->chunks_received < 10);
+    CHECK(reassembler.frames_completed == 0);
+    WireNack nack;
+    CHECK(!wire_reassembler_next_nack(&reassembler, timeout + 100 * MS, &nack));
+
+    // So is a chunk of an older frame that maps to the same slot
+    build_chunks(frame_id - WIRE_REASSEMBLY_SLOTS, frame, TEST_FRAME_BYTES, datagrams, lengths);
+    CHECK(wire_reassembler_add(&reassembler, datagrams[0], lengths[0], timeout + MS) == NULL);
+    CHECK(slot->frame_num == frame_id);
+
+    // The next frame in that slot takes it over and completes normally
+    uint32_t next_id = frame_id + WIRE_REASSEMBLY_SLOTS;
+    fill_frame(frame, TEST_FRAME_BYTES, 5);
+    build_chunks(next_id, frame, TEST_FRAME_BYTES, datagrams, lengths);
+    const WireFrameSlot* done = NULL;
+    for (int i = 0; i < TEST_DATAGRAMS; i++) {
+        const WireFrameSlot* added = wire_reassembler_add(&reassembler, datagrams[i],
+                                                          lengths[i], timeout + 2 * MS);
+        if (added) done = added;
+    }
+    CHECK(done == slot);
+    CHECK(done && done->frame_num == next_id && !done->timed_out);
+    CHECK(done && memcmp(done->data, frame, TEST_FRAME_BYTES) == 0);
+    CHECK(reassembler.frames_abandoned == 0);   // Timed out is not counted twice
+    wire_reassembler_free(&reassembler);
+    passed("an incomplete frame is dropped at the timeout, late chunks ignored, slot reused",
+           before);
+}
+
+static int loopback_socket(struct sockaddr_in* addr) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(*addr);
+    if (sock < 0 || bind(sock, (struct sockaddr*)addr, sizeof(*addr)) != 0 ||
+        getsockname(sock, (struct sockaddr*)addr, &length) != 0) {
+        return -1;
+    }
+    struct timeval wait = {0, 200000};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &wait, sizeof(wait));
+    return sock;
+}
+
+// Feeds the reassembler every chunk waiting on sock, except data chunks
+// listed in drop. Returns the completed frame, if any.
+static const WireFrameSlot* receive_chunks(int sock, WireReassembler* reassembler,
+                                           const int* drop, int drops) {
+    static uint8_t datagram[WIRE_MAX_DATAGRAM];
+    const WireFrameSlot* done = NULL;
+    ssize_t length;
+    while ((length = recv(sock, datagram, sizeof(datagram), 0)) > 0) {
+        WireChunkHeader chunk;
+        if (!wire_chunk_header_decode(datagram, (size_t)length, &chunk)) continue;
+        bool dropped = false;
+        for (int d = 0; d < drops && !(chunk.flags & WIRE_CHUNK_PARITY); d++) {
+            dropped = dropped || chunk.chunk_id == drop[d];
+        }
+        if (dropped) continue;
+        const WireFrameSlot* slot = wire_reassembler_add(reassembler, datagram, (size_t)length,
+                                                         wire_now_ns());
+        if (slot) done = slot;
+        if (done) break;
+    }
+    return done;
+}
+
+static void test_sender_repair(void) {
+    int before = failures;
+    struct sockaddr_in client_addr, server_addr;
+    int client = loopback_socket(&client_addr);
+    int server = loopback_socket(&server_addr);
+    CHECK(client >= 0 && server >= 0);
+    if (client < 0 || server < 0) return;
+
+    // Two feeds' streams on one socket; the frame goes out on feed 1
+    TokenBucket bucket;
+    token_bucket_init(&bucket, 0, 0);
+    StreamSender senders[2];
+    for (int i = 0; i < 2; i++) {
+        CHECK(stream_sender_init(&senders[i], server, TEST_CHUNK_SIZE, TEST_FEC_GROUP, &bucket));
+        senders[i].source_id = (uint8_t)i;
+        subscriber_join(&senders[i].subscribers, &client_addr, 0);
+    }
+    WireReassembler reassembler;
+    CHECK(wire_reassembler_init(&reassembler));
+
+    // 30 data chunks; chunk 1 is rebuilt from parity, 8 and 9 must be resent
+    static uint8_t frame[30 * TEST_CHUNK_SIZE];
+    fill_frame(frame, sizeof(frame), 6);
+    CHECK(send_frame_chunks(&senders[1], 1, frame, sizeof(frame)) > 0);
+    const int drop[] = {1, 8, 9};
+    CHECK(receive_chunks(client, &reassembler, drop, 3) == NULL);
+    CHECK(reassembler.chunks_rebuilt == 1);
+
+    WireNack nack;
+    CHECK(wire_reassembler_next_nack(&reassembler, wire_now_ns() + WIRE_NACK_DELAY_MS * MS,
+                                     &nack));
+    CHECK(nack.first_chunk == 8 && nack.chunk_count == 2);
+
+    // Naming a feed the server does not have gets nothing; naming feed 1
+    // gets exactly the missing chunks from its stream
+    uint8_t message[WIRE_NACK_MAX_SIZE];
+    nack.header.source_id = 2;
+    size_t length = wire_nack_encode(&nack, message);
+    sendto(client, message, length, 0, (struct sockaddr*)&server_addr, sizeof(server_addr));
+    nack.header.source_id = 1;
+    length = wire_nack_encode(&nack, message);
+    sendto(client, message, length, 0, (struct sockaddr*)&server_addr, sizeof(server_addr));
+    usleep(10000);
+    CHECK(serve_stream_requests(senders, 2, 200 * (long long)MS) == 1);
+
+    const WireFrameSlot* done = receive_chunks(client, &reassembler, NULL, 0);
+    CHECK(done && memcmp(done->data, frame, sizeof(frame)) == 0);
+    CHECK(senders[1].repairs.chunks_resent == 2);
+    CHECK(senders[0].repairs.nacks == 0);
+    CHECK(reassembler.frames_nack_repaired == 1);
+
+    wire_reassembler_free(&reassembler);
+    for (int i = 0; i < 2; i++) stream_sender_free(&senders[i]);
+    close(client);
+    close(server);
+    passed("a NACK reaches its feed's stream, which resends exactly the missing chunks", before);
+}
+
+int main(void) {
+    printf("[Test] Stream protocol\n");
+    test_codecs();
+    test_fec();
+    test_nack();
+    test_timeout();
+    test_sender_repair();
+    printf("[Test] %d checks, %d failed\n", checks, failures);
+    return failures == 0 ? 0 : 1;
+}